@@ -0,0 +1,67 @@
+#pragma once
+#include "vector.h"
+
+#include <cstddef>
+#include <limits>
+#include <new>
+
+// Аллокатор, выравнивающий начало блока по Alignment байтам через выровненный operator new.
+// Размер блока округляется вверх до кратного Alignment, так что SIMD-цикл шагами по Alignment байт
+// может дочитать последний неполный шаг без отдельной обработки остатка: хвост за Size() —
+// это запас, а не элементы.
+// Alignment по умолчанию равен строке кэша, для AVX2 достаточно 32, для AVX-512 — 64
+template <typename T, size_t Alignment = kCacheLineSize>
+class AlignedAllocator {
+    static_assert((Alignment & (Alignment - 1)) == 0, "alignment must be a power of two");
+    static_assert(Alignment >= alignof(T), "alignment must not be weaker than alignof(T)");
+
+public:
+    using value_type = T;
+
+    static constexpr size_t kAlignment = Alignment;
+
+    template <typename U>
+    struct rebind {
+        using other = AlignedAllocator<U, Alignment>;
+    };
+
+    AlignedAllocator() noexcept = default;
+
+    template <typename U>
+    AlignedAllocator(const AlignedAllocator<U, Alignment>& /*other*/) noexcept {  // NOLINT(google-explicit-constructor)
+    }
+
+    // Число элементов, которое можно обработать целыми шагами по Alignment байт, не выходя за блок
+    static constexpr size_t PaddedSize(size_t n) noexcept {
+        return PaddedBytes(n * sizeof(T)) / sizeof(T);
+    }
+
+    T* allocate(size_t n) {
+        if (n > std::numeric_limits<size_t>::max() / sizeof(T) - Alignment) {
+            throw std::bad_array_new_length();
+        }
+        return static_cast<T*>(::operator new(PaddedBytes(n * sizeof(T)), std::align_val_t{Alignment}));
+    }
+
+    void deallocate(T* buf, size_t /*n*/) noexcept {
+        ::operator delete(buf, std::align_val_t{Alignment});
+    }
+
+    template <typename U>
+    bool operator==(const AlignedAllocator<U, Alignment>& /*other*/) const noexcept {
+        return true;
+    }
+
+    template <typename U>
+    bool operator!=(const AlignedAllocator<U, Alignment>& /*other*/) const noexcept {
+        return false;
+    }
+
+private:
+    static constexpr size_t PaddedBytes(size_t bytes) noexcept {
+        return (bytes + Alignment - 1) / Alignment * Alignment;
+    }
+};
+
+template <typename T, size_t Alignment = kCacheLineSize, typename Growth = DoublingGrowth>
+using AlignedVector = Vector<T, AlignedAllocator<T, Alignment>, Growth>;
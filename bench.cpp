@@ -0,0 +1,450 @@
+// Сравнение Vector и std::vector на Google Benchmark.
+// Имеет смысл собирать с оптимизацией: cmake -DCMAKE_BUILD_TYPE=Release.
+// Наибольший размер контейнера задаётся переменной окружения VECTOR_BENCH_MAX_SIZE
+// (по умолчанию 1'000'000, для полного прогона — 100'000'000).
+// Для каждого случая выводятся время одной операции (time/op), число выделений памяти на итерацию,
+// пик памяти в куче за итерацию и пиковый RSS процесса
+#include "vector.h"
+
+#include <benchmark/benchmark.h>
+
+#include <algorithm>
+#include <atomic>
+#include <cstdlib>
+#include <new>
+#include <numeric>
+#include <string>
+#include <vector>
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <sys/resource.h>
+#endif
+
+namespace {
+
+    // Учёт выделений памяти через замену глобальных operator new/delete.
+    // Перед блоком хранится его размер, чтобы считать объём живой памяти
+    std::atomic<size_t> num_allocations{0};
+    std::atomic<size_t> live_bytes{0};
+    std::atomic<size_t> peak_bytes{0};
+
+    constexpr size_t kHeaderSize = alignof(std::max_align_t);
+
+    void* CountedAllocate(size_t size) {
+        void* block = std::malloc(size + kHeaderSize);
+        if (block == nullptr) {
+            throw std::bad_alloc();
+        }
+        *static_cast<size_t*>(block) = size;
+        ++num_allocations;
+        const size_t live = live_bytes += size;
+        size_t peak = peak_bytes.load();
+        while (live > peak && !peak_bytes.compare_exchange_weak(peak, live)) {
+        }
+        return static_cast<unsigned char*>(block) + kHeaderSize;
+    }
+
+    void CountedDeallocate(void* ptr) noexcept {
+        if (ptr == nullptr) {
+            return;
+        }
+        void* block = static_cast<unsigned char*>(ptr) - kHeaderSize;
+        live_bytes -= *static_cast<size_t*>(block);
+        std::free(block);
+    }
+
+    long PeakRssKiB() {
+#if defined(__unix__) || defined(__APPLE__)
+        rusage usage{};
+        getrusage(RUSAGE_SELF, &usage);
+        return usage.ru_maxrss;
+#else
+        return 0;
+#endif
+    }
+
+    struct Pod {
+        int64_t a = 0;
+        int64_t b = 0;
+        double c = 0;
+        double d = 0;
+    };
+
+    // Тип без noexcept у перемещения: при росте контейнеры обязаны его копировать
+    struct ThrowingMove {
+        ThrowingMove() = default;
+        explicit ThrowingMove(std::string value)
+                : value(std::move(value)) {
+        }
+        ThrowingMove(const ThrowingMove&) = default;
+        ThrowingMove(ThrowingMove&& other)  // NOLINT(performance-noexcept-move-constructor)
+                : value(std::move(other.value)) {
+        }
+        ThrowingMove& operator=(const ThrowingMove&) = default;
+        ThrowingMove& operator=(ThrowingMove&& other) {  // NOLINT(performance-noexcept-move-constructor)
+            value = std::move(other.value);
+            return *this;
+        }
+
+        std::string value;
+    };
+
+    template <typename T>
+    T MakeValue(size_t i) {
+        if constexpr (std::is_same_v<T, int>) {
+            return static_cast<int>(i);
+        } else if constexpr (std::is_same_v<T, float>) {
+            return static_cast<float>(i % 1024);
+        } else if constexpr (std::is_same_v<T, Pod>) {
+            return Pod{static_cast<int64_t>(i), static_cast<int64_t>(i), 0.5, 0.25};
+        } else if constexpr (std::is_same_v<T, std::string>) {
+            // Длиннее буфера SSO, чтобы строка жила в куче
+            return "benchmark-value-" + std::to_string(i);
+        } else {
+            return T(MakeValue<std::string>(i));
+        }
+    }
+
+    // Единый интерфейс к обоим контейнерам
+    template <typename T>
+    struct StdVectorOps {
+        using Container = std::vector<T>;
+        static void PushBack(Container& v, const T& value) {
+            v.push_back(value);
+        }
+        static void EmplaceBack(Container& v, size_t i) {
+            v.emplace_back(MakeValue<T>(i));
+        }
+        static void InsertMiddle(Container& v, const T& value) {
+            v.insert(v.begin() + v.size() / 2, value);
+        }
+        static void EraseMiddle(Container& v) {
+            v.erase(v.begin() + v.size() / 2);
+        }
+        static void Reserve(Container& v, size_t n) {
+            v.reserve(n);
+        }
+        static size_t Size(const Container& v) {
+            return v.size();
+        }
+    };
+
+    template <typename T>
+    struct VectorOps {
+        using Container = Vector<T>;
+        static void PushBack(Container& v, const T& value) {
+            v.PushBack(value);
+        }
+        static void EmplaceBack(Container& v, size_t i) {
+            v.EmplaceBack(MakeValue<T>(i));
+        }
+        static void InsertMiddle(Container& v, const T& value) {
+            v.Insert(v.begin() + v.Size() / 2, value);
+        }
+        static void EraseMiddle(Container& v) {
+            v.Erase(v.begin() + v.Size() / 2);
+        }
+        static void Reserve(Container& v, size_t n) {
+            v.Reserve(n);
+        }
+        static size_t Size(const Container& v) {
+            return v.Size();
+        }
+    };
+
+    template <typename Ops>
+    typename Ops::Container Build(size_t n) {
+        typename Ops::Container v;
+        Ops::Reserve(v, n);
+        for (size_t i = 0; i < n; ++i) {
+            Ops::EmplaceBack(v, i);
+        }
+        return v;
+    }
+
+    // Запускает body на каждой итерации и выставляет общие счётчики; ops — число операций за итерацию
+    template <typename Body>
+    void Measure(benchmark::State& state, size_t ops, Body body) {
+        const size_t allocations_before = num_allocations.load();
+        size_t peak = 0;
+        for (auto _ : state) {
+            state.PauseTiming();
+            peak_bytes = live_bytes.load();
+            const size_t base = live_bytes.load();
+            state.ResumeTiming();
+
+            body(state);
+
+            peak = std::max(peak, peak_bytes.load() - base);
+        }
+        const auto iterations = static_cast<double>(state.iterations());
+        // Обратная величина темпа: время одной операции в секундах (выводится с приставкой, например 20n)
+        state.counters["time/op"] = benchmark::Counter(
+                static_cast<double>(ops), benchmark::Counter::kIsIterationInvariantRate | benchmark::Counter::kInvert);
+        state.counters["allocs"] = static_cast<double>(num_allocations.load() - allocations_before) / iterations;
+        state.counters["peak_heap_KiB"] = static_cast<double>(peak) / 1024.0;
+        state.counters["rss_KiB"] = static_cast<double>(PeakRssKiB());
+    }
+
+    template <typename Ops, typename T>
+    void BM_PushBack(benchmark::State& state) {
+        const auto n = static_cast<size_t>(state.range(0));
+        const T value = MakeValue<T>(n);
+        Measure(state, n, [&](benchmark::State&) {
+            typename Ops::Container v;
+            for (size_t i = 0; i < n; ++i) {
+                Ops::PushBack(v, value);
+            }
+            benchmark::DoNotOptimize(Ops::Size(v));
+        });
+    }
+
+    template <typename Ops, typename T>
+    void BM_EmplaceBack(benchmark::State& state) {
+        const auto n = static_cast<size_t>(state.range(0));
+        Measure(state, n, [&](benchmark::State&) {
+            typename Ops::Container v;
+            for (size_t i = 0; i < n; ++i) {
+                Ops::EmplaceBack(v, i);
+            }
+            benchmark::DoNotOptimize(Ops::Size(v));
+        });
+    }
+
+    template <typename Ops, typename T>
+    void BM_ReservePushBack(benchmark::State& state) {
+        const auto n = static_cast<size_t>(state.range(0));
+        const T value = MakeValue<T>(n);
+        Measure(state, n, [&](benchmark::State&) {
+            typename Ops::Container v;
+            Ops::Reserve(v, n);
+            for (size_t i = 0; i < n; ++i) {
+                Ops::PushBack(v, value);
+            }
+            benchmark::DoNotOptimize(Ops::Size(v));
+        });
+    }
+
+    template <typename Ops, typename T>
+    void BM_InsertMiddle(benchmark::State& state) {
+        const auto n = static_cast<size_t>(state.range(0));
+        const T value = MakeValue<T>(n);
+        Measure(state, n, [&](benchmark::State&) {
+            typename Ops::Container v;
+            for (size_t i = 0; i < n; ++i) {
+                Ops::InsertMiddle(v, value);
+            }
+            benchmark::DoNotOptimize(Ops::Size(v));
+        });
+    }
+
+    template <typename Ops, typename T>
+    void BM_EraseMiddle(benchmark::State& state) {
+        const auto n = static_cast<size_t>(state.range(0));
+        Measure(state, n, [&](benchmark::State& s) {
+            s.PauseTiming();
+            auto v = Build<Ops>(n);
+            s.ResumeTiming();
+            while (Ops::Size(v) != 0) {
+                Ops::EraseMiddle(v);
+            }
+            benchmark::DoNotOptimize(Ops::Size(v));
+        });
+    }
+
+    template <typename Ops, typename T>
+    void BM_Copy(benchmark::State& state) {
+        const auto n = static_cast<size_t>(state.range(0));
+        const auto source = Build<Ops>(n);
+        Measure(state, n, [&](benchmark::State&) {
+            typename Ops::Container copy(source);
+            benchmark::DoNotOptimize(Ops::Size(copy));
+        });
+    }
+
+    template <typename Ops, typename T>
+    void BM_Move(benchmark::State& state) {
+        const auto n = static_cast<size_t>(state.range(0));
+        auto source = Build<Ops>(n);
+        Measure(state, 2, [&](benchmark::State&) {
+            typename Ops::Container moved(std::move(source));
+            source = std::move(moved);
+            benchmark::DoNotOptimize(Ops::Size(source));
+        });
+    }
+
+    // Редукции: std::accumulate и std::equal против блочных ядер Vector
+    template <typename T>
+    void BM_StdSum(benchmark::State& state) {
+        const auto n = static_cast<size_t>(state.range(0));
+        const auto v = Build<StdVectorOps<T>>(n);
+        Measure(state, n, [&](benchmark::State&) {
+            benchmark::DoNotOptimize(std::accumulate(v.begin(), v.end(), simd::SumType<T>{}));
+        });
+    }
+
+    template <typename T>
+    void BM_VectorSum(benchmark::State& state) {
+        const auto n = static_cast<size_t>(state.range(0));
+        const auto v = Build<VectorOps<T>>(n);
+        Measure(state, n, [&](benchmark::State&) {
+            benchmark::DoNotOptimize(v.Sum());
+        });
+    }
+
+    template <typename T>
+    void BM_StdEqual(benchmark::State& state) {
+        const auto n = static_cast<size_t>(state.range(0));
+        const auto v = Build<StdVectorOps<T>>(n);
+        const auto copy = v;
+        Measure(state, n, [&](benchmark::State&) {
+            benchmark::DoNotOptimize(v == copy);
+        });
+    }
+
+    template <typename T>
+    void BM_VectorEqual(benchmark::State& state) {
+        const auto n = static_cast<size_t>(state.range(0));
+        const auto v = Build<VectorOps<T>>(n);
+        const auto copy = v;
+        Measure(state, n, [&](benchmark::State&) {
+            benchmark::DoNotOptimize(v == copy);
+        });
+    }
+
+    // Сортировка перемешанных значений; копия для каждой итерации готовится вне замера
+    template <typename Ops, typename T, typename SortFn>
+    void MeasureSort(benchmark::State& state, SortFn sort) {
+        const auto n = static_cast<size_t>(state.range(0));
+        typename Ops::Container source;
+        Ops::Reserve(source, n);
+        for (size_t i = 0; i < n; ++i) {
+            Ops::PushBack(source, MakeValue<T>(i * 2654435761u % (n | 1)));
+        }
+        typename Ops::Container v;
+        Measure(state, n, [&](benchmark::State& s) {
+            s.PauseTiming();
+            v = source;
+            s.ResumeTiming();
+            sort(v);
+            benchmark::DoNotOptimize(v);
+        });
+    }
+
+    template <typename T>
+    void BM_StdSort(benchmark::State& state) {
+        MeasureSort<StdVectorOps<T>, T>(state, [](std::vector<T>& v) {
+            std::sort(v.begin(), v.end());
+        });
+    }
+
+    template <typename T>
+    void BM_VectorSort(benchmark::State& state) {
+        MeasureSort<VectorOps<T>, T>(state, [](Vector<T>& v) {
+            v.Sort();
+        });
+    }
+
+    template <typename T>
+    void BM_VectorParallelSort(benchmark::State& state) {
+        MeasureSort<VectorOps<T>, T>(state, [](Vector<T>& v) {
+            v.Sort(kParallel);
+        });
+    }
+
+    template <typename T>
+    void BM_StdStableSort(benchmark::State& state) {
+        MeasureSort<StdVectorOps<T>, T>(state, [](std::vector<T>& v) {
+            std::stable_sort(v.begin(), v.end());
+        });
+    }
+
+    template <typename T>
+    void BM_VectorStableSort(benchmark::State& state) {
+        MeasureSort<VectorOps<T>, T>(state, [](Vector<T>& v) {
+            v.StableSort();
+        });
+    }
+
+    // Квадратичные операции ограничиваются этим размером
+    constexpr size_t kMaxQuadraticSize = 100'000;
+
+    template <template <typename> typename Ops, typename T>
+    void RegisterForType(const std::string& container, const std::string& type, size_t max_size) {
+        const auto register_case = [&](const std::string& operation, void (*fn)(benchmark::State&), size_t limit) {
+            auto* bench = benchmark::RegisterBenchmark((operation + "/" + container + "<" + type + ">").c_str(), fn);
+            for (size_t size = 1; size <= limit; size *= 10) {
+                bench->Arg(static_cast<int64_t>(size));
+            }
+            bench->Unit(benchmark::kMicrosecond);
+        };
+        const size_t quadratic_limit = std::min(max_size, kMaxQuadraticSize);
+        register_case("PushBack", BM_PushBack<Ops<T>, T>, max_size);
+        register_case("EmplaceBack", BM_EmplaceBack<Ops<T>, T>, max_size);
+        register_case("ReservePushBack", BM_ReservePushBack<Ops<T>, T>, max_size);
+        register_case("InsertMiddle", BM_InsertMiddle<Ops<T>, T>, quadratic_limit);
+        register_case("EraseMiddle", BM_EraseMiddle<Ops<T>, T>, quadratic_limit);
+        register_case("Copy", BM_Copy<Ops<T>, T>, max_size);
+        register_case("Move", BM_Move<Ops<T>, T>, max_size);
+    }
+
+    template <typename T>
+    void RegisterReductions(const std::string& type, size_t max_size) {
+        const auto register_case = [&](const std::string& name, void (*fn)(benchmark::State&)) {
+            auto* bench = benchmark::RegisterBenchmark((name + "<" + type + ">").c_str(), fn);
+            for (size_t size = 1; size <= max_size; size *= 10) {
+                bench->Arg(static_cast<int64_t>(size));
+            }
+            bench->Unit(benchmark::kMicrosecond);
+        };
+        register_case("Sum/std::vector", BM_StdSum<T>);
+        register_case("Sum/Vector", BM_VectorSum<T>);
+        register_case("Equal/std::vector", BM_StdEqual<T>);
+        register_case("Equal/Vector", BM_VectorEqual<T>);
+        register_case("Sort/std::vector", BM_StdSort<T>);
+        register_case("Sort/Vector", BM_VectorSort<T>);
+        register_case("ParallelSort/Vector", BM_VectorParallelSort<T>);
+        register_case("StableSort/std::vector", BM_StdStableSort<T>);
+        register_case("StableSort/Vector", BM_VectorStableSort<T>);
+    }
+
+    template <typename T>
+    void RegisterType(const std::string& type, size_t max_size) {
+        RegisterForType<StdVectorOps, T>("std::vector", type, max_size);
+        RegisterForType<VectorOps, T>("Vector", type, max_size);
+    }
+
+}  // namespace
+
+void* operator new(size_t size) {
+    return CountedAllocate(size);
+}
+
+void operator delete(void* ptr) noexcept {
+    CountedDeallocate(ptr);
+}
+
+void operator delete(void* ptr, size_t /*size*/) noexcept {
+    CountedDeallocate(ptr);
+}
+
+int main(int argc, char** argv) {
+    size_t max_size = 1'000'000;
+    if (const char* env = std::getenv("VECTOR_BENCH_MAX_SIZE")) {
+        max_size = std::strtoull(env, nullptr, 10);
+    }
+
+    RegisterType<int>("int", max_size);
+    RegisterType<Pod>("Pod32", max_size);
+    RegisterType<std::string>("string", max_size);
+    RegisterType<ThrowingMove>("ThrowingMove", max_size);
+    RegisterReductions<int>("int", max_size);
+    RegisterReductions<float>("float", max_size);
+
+    benchmark::Initialize(&argc, argv);
+    if (benchmark::ReportUnrecognizedArguments(argc, argv)) {
+        return 1;
+    }
+    benchmark::RunSpecifiedBenchmarks();
+    benchmark::Shutdown();
+}
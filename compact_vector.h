@@ -0,0 +1,346 @@
+#pragma once
+#include "vector.h"
+#include "vector_check.h"
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <memory>
+#include <new>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+
+// Вектор размером в один указатель для миллионов маленьких векторов внутри других объектов.
+// Размер и ёмкость хранятся 32-битными числами в заголовке блока в куче перед элементами, поэтому
+// пустой вектор не выделяет памяти, а объект занимает один указатель вместо трёх у Vector (8 байт
+// вместо 24 на 64-битных платформах). Расплата — не больше 2^32 - 1 элементов (при превышении
+// бросается std::length_error) и дополнительное чтение заголовка в Size() и Capacity().
+// Аллокатора нет: блоки берутся из operator new с выравниванием элементов
+template <typename T, typename Growth = DoublingGrowth>
+class CompactVector {
+public:
+    static constexpr size_t kMaxSize = std::numeric_limits<uint32_t>::max();
+
+    using iterator = T*;
+    using const_iterator = const T*;
+
+    CompactVector() = default;
+    explicit CompactVector(size_t size);
+    CompactVector(const CompactVector& other);
+    CompactVector(CompactVector&& other) noexcept
+            : header_(std::exchange(other.header_, nullptr)) {
+    }
+    ~CompactVector();
+
+    CompactVector& operator=(const CompactVector& other);
+    CompactVector& operator=(CompactVector&& other) noexcept;
+
+    void Swap(CompactVector& other) noexcept {
+        std::swap(header_, other.header_);
+    }
+
+    void Reserve(size_t capacity);
+    void Resize(size_t new_size);
+    void PushBack(const T& value);
+    void PushBack(T&& value);
+    void PopBack() noexcept;
+
+    template<typename... Args>
+    T& EmplaceBack(Args&&... args);
+
+    size_t Size() const noexcept {
+        return header_ != nullptr ? header_->size : 0;
+    }
+
+    size_t Capacity() const noexcept {
+        return header_ != nullptr ? header_->capacity : 0;
+    }
+
+    bool Empty() const noexcept {
+        return Size() == 0;
+    }
+
+    T* Data() noexcept {
+        return header_ != nullptr ? Elements(header_) : nullptr;
+    }
+    const T* Data() const noexcept {
+        return const_cast<CompactVector&>(*this).Data();
+    }
+
+    const T& operator[](size_t index) const noexcept {
+        return const_cast<CompactVector&>(*this)[index];
+    }
+
+    T& operator[](size_t index) noexcept {
+        VECTOR_CHECK(index < Size());
+        return Elements(header_)[index];
+    }
+
+    iterator begin() noexcept {
+        return Data();
+    }
+    iterator end() noexcept {
+        return Data() + Size();
+    }
+    const_iterator begin() const noexcept {
+        return cbegin();
+    }
+    const_iterator end() const noexcept {
+        return cend();
+    }
+    const_iterator cbegin() const noexcept {
+        return Data();
+    }
+    const_iterator cend() const noexcept {
+        return Data() + Size();
+    }
+
+    template<typename... Args>
+    iterator Emplace(const_iterator pos, Args&&... args);
+    iterator Erase(const_iterator pos) noexcept(IsTriviallyRelocatableV<T> || std::is_nothrow_move_assignable_v<T>);
+    iterator Insert(const_iterator pos, const T& value);
+    iterator Insert(const_iterator pos, T&& value);
+
+    // Удаляет все элементы, сохраняя ёмкость
+    void Clear() noexcept;
+    // Уменьшает ёмкость до размера; пустой вектор отдаёт блок целиком
+    void ShrinkToFit();
+
+private:
+    struct Header {
+        uint32_t size;
+        uint32_t capacity;
+    };
+
+    // Элементы начинаются сразу за заголовком, выровненным под T
+    static constexpr size_t kElementsOffset = (sizeof(Header) + alignof(T) - 1) / alignof(T) * alignof(T);
+    static constexpr size_t kBlockAlignment = std::max(alignof(Header), alignof(T));
+
+    struct BlockDeleter {
+        void operator()(Header* header) const noexcept {
+            ::operator delete(header, std::align_val_t{kBlockAlignment});
+        }
+    };
+    using Block = std::unique_ptr<Header, BlockDeleter>;
+
+    Header* header_ = nullptr;
+
+    static T* Elements(Header* header) noexcept {
+        return reinterpret_cast<T*>(reinterpret_cast<unsigned char*>(header) + kElementsOffset);
+    }
+
+    // Блок под capacity элементов с нулевым размером; для нулевой ёмкости блока нет
+    static Block AllocateBlock(size_t capacity);
+
+    // Ёмкость нового блока для required элементов с учётом 32-битного предела
+    size_t NextCapacity(size_t required) const;
+
+    // Заменяет текущий блок на block, в который элементы уже перенесены
+    void ReplaceBlock(Block block, size_t size) noexcept;
+
+    template<typename... Args>
+    iterator EmplaceWithReallocation(size_t pos_index, Args&&... args);
+};
+
+
+template<typename T, typename Growth>
+typename CompactVector<T, Growth>::Block CompactVector<T, Growth>::AllocateBlock(size_t capacity) {
+    if (capacity == 0) {
+        return Block();
+    }
+    if (capacity > kMaxSize || capacity > (std::numeric_limits<size_t>::max() - kElementsOffset) / sizeof(T)) {
+        throw std::length_error("CompactVector: capacity exceeds 2^32 - 1 elements");
+    }
+    void* memory = ::operator new(kElementsOffset + capacity * sizeof(T), std::align_val_t{kBlockAlignment});
+    Block block(new (memory) Header{0, static_cast<uint32_t>(capacity)});
+    return block;
+}
+
+template<typename T, typename Growth>
+size_t CompactVector<T, Growth>::NextCapacity(size_t required) const {
+    if (required > kMaxSize) {
+        throw std::length_error("CompactVector: size exceeds 2^32 - 1 elements");
+    }
+    return std::min(Growth::NextCapacity(Capacity(), required, sizeof(T)), kMaxSize);
+}
+
+template<typename T, typename Growth>
+void CompactVector<T, Growth>::ReplaceBlock(Block block, size_t size) noexcept {
+    if (block != nullptr) {
+        block->size = static_cast<uint32_t>(size);
+    }
+    Block old(std::exchange(header_, block.release()));
+}
+
+template<typename T, typename Growth>
+CompactVector<T, Growth>::CompactVector(size_t size) {
+    Block block = AllocateBlock(size);
+    if (size != 0) {
+        detail::ValueConstructN(Elements(block.get()), size);
+    }
+    ReplaceBlock(std::move(block), size);
+}
+
+template<typename T, typename Growth>
+CompactVector<T, Growth>::CompactVector(const CompactVector& other) {
+    const size_t size = other.Size();
+    Block block = AllocateBlock(size);
+    if (size != 0) {
+        detail::CopyConstructN(other.Data(), size, Elements(block.get()));
+    }
+    ReplaceBlock(std::move(block), size);
+}
+
+template<typename T, typename Growth>
+CompactVector<T, Growth>::~CompactVector() {
+    Clear();
+    if (header_ != nullptr) {
+        BlockDeleter()(header_);
+    }
+}
+
+template<typename T, typename Growth>
+CompactVector<T, Growth>& CompactVector<T, Growth>::operator=(const CompactVector& other) {
+    if (&other != this) {
+        CompactVector other_copy(other);
+        Swap(other_copy);
+    }
+    return *this;
+}
+
+template<typename T, typename Growth>
+CompactVector<T, Growth>& CompactVector<T, Growth>::operator=(CompactVector&& other) noexcept {
+    if (&other != this) {
+        CompactVector(std::move(other)).Swap(*this);
+    }
+    return *this;
+}
+
+template<typename T, typename Growth>
+void CompactVector<T, Growth>::Reserve(size_t capacity) {
+    if (capacity <= Capacity()) {
+        return;
+    }
+    const size_t size = Size();
+    Block block = AllocateBlock(capacity);
+    detail::RelocateN(Data(), size, Elements(block.get()));
+    ReplaceBlock(std::move(block), size);
+}
+
+template<typename T, typename Growth>
+void CompactVector<T, Growth>::Resize(size_t new_size) {
+    const size_t size = Size();
+    if (new_size < size) {
+        detail::DestroyN(Data() + new_size, size - new_size);
+        header_->size = static_cast<uint32_t>(new_size);
+    } else if (new_size > size) {
+        Reserve(new_size);
+        detail::ValueConstructN(Data() + size, new_size - size);
+        header_->size = static_cast<uint32_t>(new_size);
+    }
+}
+
+template<typename T, typename Growth>
+void CompactVector<T, Growth>::PushBack(const T& value) {
+    EmplaceBack(value);
+}
+
+template<typename T, typename Growth>
+void CompactVector<T, Growth>::PushBack(T&& value) {
+    EmplaceBack(std::move(value));
+}
+
+template<typename T, typename Growth>
+void CompactVector<T, Growth>::PopBack() noexcept {
+    VECTOR_CHECK(Size() != 0);
+    Elements(header_)[--header_->size].~T();
+}
+
+template<typename T, typename Growth>
+template<typename... Args>
+T& CompactVector<T, Growth>::EmplaceBack(Args&&... args) {
+    const size_t size = Size();
+    if (size == Capacity()) {
+        return *EmplaceWithReallocation(size, std::forward<Args>(args)...);
+    }
+    T* element = new (Elements(header_) + size) T (std::forward<Args>(args)...);
+    ++header_->size;
+    return *element;
+}
+
+template<typename T, typename Growth>
+template<typename... Args>
+typename CompactVector<T, Growth>::iterator CompactVector<T, Growth>::Emplace(const_iterator pos, Args&&... args) {
+    VECTOR_CHECK(detail::PointerInRange(pos, cbegin(), cend()));
+
+    const size_t pos_index = pos - cbegin();
+    const size_t size = Size();
+    if (size == Capacity()) {
+        return EmplaceWithReallocation(pos_index, std::forward<Args>(args)...);
+    }
+
+    iterator result = detail::EmplaceInPlace(Data(), size, pos_index, std::forward<Args>(args)...);
+    ++header_->size;
+    return result;
+}
+
+// Элемент создаётся в новом блоке до переноса старых, чтобы аргументы могли ссылаться на элементы вектора
+template<typename T, typename Growth>
+template<typename... Args>
+typename CompactVector<T, Growth>::iterator CompactVector<T, Growth>::EmplaceWithReallocation(size_t pos_index,
+                                                                                             Args&&... args) {
+    const size_t size = Size();
+    Block block = AllocateBlock(NextCapacity(size + 1));
+    T* new_pos = Elements(block.get()) + pos_index;
+    new (new_pos) T (std::forward<Args>(args)...);
+
+    try {
+        detail::RelocateWithGap(Data(), size, pos_index, Elements(block.get()));
+    } catch (...) {
+        new_pos->~T();
+        throw;
+    }
+    ReplaceBlock(std::move(block), size + 1);
+    return new_pos;
+}
+
+template<typename T, typename Growth>
+typename CompactVector<T, Growth>::iterator CompactVector<T, Growth>::Insert(const_iterator pos, const T& value) {
+    return Emplace(pos, value);
+}
+
+template<typename T, typename Growth>
+typename CompactVector<T, Growth>::iterator CompactVector<T, Growth>::Insert(const_iterator pos, T&& value) {
+    return Emplace(pos, std::move(value));
+}
+
+template<typename T, typename Growth>
+typename CompactVector<T, Growth>::iterator CompactVector<T, Growth>::Erase(const_iterator pos)
+        noexcept(IsTriviallyRelocatableV<T> || std::is_nothrow_move_assignable_v<T>) {
+    VECTOR_CHECK(detail::PointerInRange(pos, cbegin(), cend()) && pos != cend());
+
+    iterator result = detail::EraseAt(Data(), Size(), pos - cbegin());
+    --header_->size;
+    return result;
+}
+
+template<typename T, typename Growth>
+void CompactVector<T, Growth>::Clear() noexcept {
+    if (header_ != nullptr) {
+        detail::DestroyN(Elements(header_), header_->size);
+        header_->size = 0;
+    }
+}
+
+template<typename T, typename Growth>
+void CompactVector<T, Growth>::ShrinkToFit() {
+    const size_t size = Size();
+    if (size == Capacity()) {
+        return;
+    }
+    Block block = AllocateBlock(size);
+    detail::RelocateN(Data(), size, block != nullptr ? Elements(block.get()) : nullptr);
+    ReplaceBlock(std::move(block), size);
+}
@@ -0,0 +1,265 @@
+#pragma once
+#include "vector.h"
+#include "vector_check.h"
+#include "index_iterator.h"
+#include "segmented_vector.h"
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <limits>
+#include <memory>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+namespace detail {
+
+constexpr size_t FloorLog2(size_t value) noexcept {
+#if defined(__GNUC__) || defined(__clang__)
+    return std::numeric_limits<size_t>::digits - 1 - static_cast<size_t>(__builtin_clzll(value));
+#else
+    size_t result = 0;
+    while (value >>= 1) {
+        ++result;
+    }
+    return result;
+#endif
+}
+
+}  // namespace detail
+
+// Вектор для одновременного добавления из многих потоков без мьютекса. Элементы лежат в сегментах,
+// каждый следующий вдвое больше предыдущего (первый — FirstSegmentSize элементов); сегменты никогда
+// не перевыделяются, поэтому элементы не двигаются, а ссылки на них остаются действительными.
+// EmplaceBack занимает индекс атомарным CAS-ом по счётчику reserved_, конструирует элемент и помечает
+// ячейку готовой; Size() растёт только по непрерывному префиксу готовых ячеек, и его продвигает
+// тот поток, который первым это заметит. Поэтому элементы [0, Size()) всегда сконструированы, и их
+// можно читать параллельно с добавлением. Clear и разрушение требуют исключительного доступа
+template <typename T, size_t FirstSegmentSize = detail::DefaultChunkSize(sizeof(T))>
+class ConcurrentVector {
+    static_assert(FirstSegmentSize > 0 && (FirstSegmentSize & (FirstSegmentSize - 1)) == 0,
+                  "first segment size must be a power of two");
+
+    struct Segment;
+
+public:
+    static constexpr size_t kFirstSegmentSize = FirstSegmentSize;
+
+    // Неизменяемый префикс вектора на момент вызова Snapshot; добавления после этого в нём не видны
+    class View {
+    public:
+        using const_iterator = IndexIterator<const View, T>;
+        using iterator = const_iterator;
+
+        View(const ConcurrentVector* owner, size_t size) noexcept
+                : owner_(owner), size_(size) {
+        }
+
+        size_t Size() const noexcept {
+            return size_;
+        }
+
+        const T& operator[](size_t index) const noexcept {
+            VECTOR_CHECK(index < size_);
+            return (*owner_)[index];
+        }
+
+        const_iterator begin() const noexcept {
+            return {this, 0};
+        }
+        const_iterator end() const noexcept {
+            return {this, size_};
+        }
+
+    private:
+        const ConcurrentVector* owner_;
+        size_t size_;
+    };
+
+    ConcurrentVector() = default;
+    // Общий журнал не переносят и не копируют, пока в него пишут; для передачи хватает указателя
+    ConcurrentVector(const ConcurrentVector&) = delete;
+    ConcurrentVector& operator=(const ConcurrentVector&) = delete;
+    ~ConcurrentVector();
+
+    // Потокобезопасно; при исключении вектор не меняется. Если конструирование T может бросить,
+    // элемент сначала создаётся во временном объекте и затем переносится, поэтому T в этом случае
+    // должен переноситься без исключений
+    template <typename... Args>
+    T& EmplaceBack(Args&&... args);
+
+    void PushBack(const T& value) {
+        EmplaceBack(value);
+    }
+
+    void PushBack(T&& value) {
+        EmplaceBack(std::move(value));
+    }
+
+    // Потокобезопасно заранее выделяет сегменты под capacity элементов
+    void Reserve(size_t capacity);
+
+    // Удаляет все элементы и освобождает сегменты. Не потокобезопасно
+    void Clear() noexcept;
+
+    // Число опубликованных элементов: все они сконструированы и видны вызывающему потоку
+    size_t Size() const noexcept {
+        return published_.load(std::memory_order_acquire);
+    }
+
+    View Snapshot() const noexcept {
+        return {this, Size()};
+    }
+
+    // Индекс должен быть меньше ранее полученного Size()
+    const T& operator[](size_t index) const noexcept {
+        return const_cast<ConcurrentVector&>(*this)[index];
+    }
+
+    T& operator[](size_t index) noexcept {
+        const auto [segment, offset] = Locate(index);
+        return segments_[segment].load(std::memory_order_acquire)->storage[offset];
+    }
+
+private:
+    // Ёмкость и флаги готовности ячеек сегмента хранятся рядом
+    struct Segment {
+        explicit Segment(size_t capacity)
+                : storage(capacity), ready(std::make_unique<std::atomic<bool>[]>(capacity)) {
+        }
+
+        RawMemory<T> storage;
+        std::unique_ptr<std::atomic<bool>[]> ready;
+    };
+
+    static constexpr size_t kFirstSegmentShift = detail::FloorLog2(FirstSegmentSize);
+    static constexpr size_t kMaxSegments = std::numeric_limits<size_t>::digits - kFirstSegmentShift;
+
+    // Сегмент k начинается с индекса F * (2^k - 1) и вмещает F * 2^k элементов
+    static std::pair<size_t, size_t> Locate(size_t index) noexcept {
+        const size_t segment = detail::FloorLog2((index >> kFirstSegmentShift) + 1);
+        return {segment, index - SegmentBegin(segment)};
+    }
+
+    static constexpr size_t SegmentBegin(size_t segment) noexcept {
+        return ((size_t{1} << segment) - 1) << kFirstSegmentShift;
+    }
+
+    static constexpr size_t SegmentCapacity(size_t segment) noexcept {
+        return FirstSegmentSize << segment;
+    }
+
+    // Возвращает сегмент, создавая его при необходимости; проигравший гонку поток освобождает свой
+    Segment& EnsureSegment(size_t segment);
+
+    // Ячейка index сконструирована
+    bool IsReady(size_t index) const noexcept;
+
+    // Продвигает published_ по готовым ячейкам
+    void Publish() noexcept;
+
+    std::array<std::atomic<Segment*>, kMaxSegments> segments_{};
+    // Счётчики меняются разными потоками на каждом добавлении, поэтому живут на разных строках кэша
+    alignas(kCacheLineSize) std::atomic<size_t> reserved_{0};
+    alignas(kCacheLineSize) std::atomic<size_t> published_{0};
+};
+
+
+template <typename T, size_t FirstSegmentSize>
+ConcurrentVector<T, FirstSegmentSize>::~ConcurrentVector() {
+    Clear();
+}
+
+template <typename T, size_t FirstSegmentSize>
+typename ConcurrentVector<T, FirstSegmentSize>::Segment& ConcurrentVector<T, FirstSegmentSize>::EnsureSegment(
+        size_t segment) {
+    VECTOR_CHECK(segment < kMaxSegments);
+    Segment* current = segments_[segment].load(std::memory_order_acquire);
+    if (current != nullptr) {
+        return *current;
+    }
+    auto created = std::make_unique<Segment>(SegmentCapacity(segment));
+    if (segments_[segment].compare_exchange_strong(current, created.get(), std::memory_order_acq_rel,
+                                                   std::memory_order_acquire)) {
+        return *created.release();
+    }
+    return *current;
+}
+
+template <typename T, size_t FirstSegmentSize>
+bool ConcurrentVector<T, FirstSegmentSize>::IsReady(size_t index) const noexcept {
+    const auto [segment, offset] = Locate(index);
+    const Segment* current = segments_[segment].load(std::memory_order_acquire);
+    return current != nullptr && current->ready[offset].load();
+}
+
+// Поток, пометивший ячейку готовой, либо сам продвигает published_ через неё, либо видит, что предыдущая
+// ячейка ещё не готова; тогда её владелец после пометки увидит готовую ячейку этого потока. Для этого
+// флаги и счётчик используют последовательно согласованный порядок
+template <typename T, size_t FirstSegmentSize>
+void ConcurrentVector<T, FirstSegmentSize>::Publish() noexcept {
+    size_t published = published_.load();
+    while (published < reserved_.load() && IsReady(published)) {
+        if (published_.compare_exchange_weak(published, published + 1)) {
+            ++published;
+        }
+    }
+}
+
+// Индекс занимается только после того, как сегмент для него уже есть, а элемент конструируется
+// без исключений, поэтому занятая ячейка всегда будет заполнена и в опубликованном префиксе нет дыр
+template <typename T, size_t FirstSegmentSize>
+template <typename... Args>
+T& ConcurrentVector<T, FirstSegmentSize>::EmplaceBack(Args&&... args) {
+    if constexpr (std::is_nothrow_constructible_v<T, Args...>) {
+        size_t index = reserved_.load(std::memory_order_relaxed);
+        Segment* segment;
+        size_t offset;
+        do {
+            const auto location = Locate(index);
+            segment = &EnsureSegment(location.first);
+            offset = location.second;
+        } while (!reserved_.compare_exchange_weak(index, index + 1, std::memory_order_relaxed));
+
+        T* element = new (segment->storage + offset) T(std::forward<Args>(args)...);
+        segment->ready[offset].store(true);
+        Publish();
+        return *element;
+    } else {
+        static_assert(std::is_nothrow_move_constructible_v<T>,
+                      "elements with a throwing constructor must be nothrow move constructible");
+        T value(std::forward<Args>(args)...);
+        return EmplaceBack(std::move(value));
+    }
+}
+
+template <typename T, size_t FirstSegmentSize>
+void ConcurrentVector<T, FirstSegmentSize>::Reserve(size_t capacity) {
+    if (capacity == 0) {
+        return;
+    }
+    const size_t last_segment = Locate(capacity - 1).first;
+    for (size_t segment = 0; segment <= last_segment; ++segment) {
+        EnsureSegment(segment);
+    }
+}
+
+template <typename T, size_t FirstSegmentSize>
+void ConcurrentVector<T, FirstSegmentSize>::Clear() noexcept {
+    const size_t size = reserved_.load(std::memory_order_acquire);
+    for (size_t segment = 0; segment < kMaxSegments; ++segment) {
+        Segment* current = segments_[segment].exchange(nullptr, std::memory_order_acq_rel);
+        if (current == nullptr) {
+            continue;
+        }
+        if constexpr (!std::is_trivially_destructible_v<T>) {
+            const size_t begin = SegmentBegin(segment);
+            const size_t count = size > begin ? std::min(size - begin, SegmentCapacity(segment)) : 0;
+            detail::DestroyN(current->storage.GetAddress(), count);
+        }
+        delete current;
+    }
+    reserved_.store(0, std::memory_order_relaxed);
+    published_.store(0, std::memory_order_release);
+}
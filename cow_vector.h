@@ -0,0 +1,217 @@
+#pragma once
+#include "vector.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <utility>
+
+// Вектор с общим буфером и копированием при записи: копия CowVector стоит O(1) и лишь увеличивает
+// счётчик ссылок, а первая изменяющая операция над разделяемым буфером делает себе собственную копию.
+// Читать можно только через константный интерфейс — неконстантный operator[] незаметно копировал бы
+// буфер; для изменений есть Mutate() и явные методы. Как и shared_ptr, разные объекты, разделяющие
+// буфер, можно читать и менять из разных потоков, а один объект — нет
+template <typename T>
+class CowVector {
+public:
+    using const_iterator = typename Vector<T>::const_iterator;
+    using iterator = const_iterator;
+
+    CowVector() = default;
+    explicit CowVector(Vector<T> values);
+    CowVector(const CowVector& other) noexcept;
+    CowVector(CowVector&& other) noexcept
+            : shared_(std::exchange(other.shared_, nullptr)) {
+    }
+    ~CowVector() {
+        Unref();
+    }
+
+    CowVector& operator=(const CowVector& other) noexcept;
+    CowVector& operator=(CowVector&& other) noexcept;
+
+    void Swap(CowVector& other) noexcept {
+        std::swap(shared_, other.shared_);
+    }
+
+    const Vector<T>& Get() const noexcept;
+
+    size_t Size() const noexcept {
+        return shared_ != nullptr ? shared_->values.Size() : 0;
+    }
+
+    bool Empty() const noexcept {
+        return Size() == 0;
+    }
+
+    const T& operator[](size_t index) const noexcept {
+        return Get()[index];
+    }
+
+    const_iterator begin() const noexcept {
+        return Get().begin();
+    }
+    const_iterator end() const noexcept {
+        return Get().end();
+    }
+    const_iterator cbegin() const noexcept {
+        return begin();
+    }
+    const_iterator cend() const noexcept {
+        return end();
+    }
+
+    // Буфер разделён хотя бы с одной копией
+    bool IsShared() const noexcept {
+        return shared_ != nullptr && shared_->refs.load(std::memory_order_acquire) > 1;
+    }
+
+    // Собственный вектор для изменения; разделяемый буфер перед этим копируется. Менять элементы через
+    // ссылку можно только до следующего копирования этого объекта, иначе изменения увидит и копия
+    Vector<T>& Mutate();
+
+    void PushBack(const T& value) {
+        EmplaceBack(value);
+    }
+
+    void PushBack(T&& value) {
+        EmplaceBack(std::move(value));
+    }
+
+    template <typename... Args>
+    T& EmplaceBack(Args&&... args);
+
+    void PopBack() {
+        Mutate().PopBack();
+    }
+
+    void Resize(size_t new_size) {
+        Mutate().Resize(new_size);
+    }
+
+    void Set(size_t index, T value) {
+        Mutate()[index] = std::move(value);
+    }
+
+    // Разделяемый буфер просто отпускается, не копируясь
+    void Clear() noexcept;
+
+    // Забирает элементы в обычный Vector: единственный владелец переносит их без копирования.
+    // Объект остаётся пустым
+    Vector<T> Extract();
+
+private:
+    struct Shared {
+        explicit Shared(Vector<T>&& values) noexcept
+                : values(std::move(values)) {
+        }
+
+        std::atomic<size_t> refs{1};
+        Vector<T> values;
+    };
+
+    Shared* shared_ = nullptr;
+
+    // Переходит на собственный буфер ёмкостью не меньше capacity
+    void Detach(size_t capacity);
+
+    void Unref() noexcept;
+};
+
+
+template <typename T>
+CowVector<T>::CowVector(Vector<T> values)
+        : shared_(new Shared(std::move(values))) {
+}
+
+template <typename T>
+CowVector<T>::CowVector(const CowVector& other) noexcept
+        : shared_(other.shared_) {
+    if (shared_ != nullptr) {
+        shared_->refs.fetch_add(1, std::memory_order_relaxed);
+    }
+}
+
+template <typename T>
+CowVector<T>& CowVector<T>::operator=(const CowVector& other) noexcept {
+    if (shared_ != other.shared_) {
+        CowVector(other).Swap(*this);
+    }
+    return *this;
+}
+
+template <typename T>
+CowVector<T>& CowVector<T>::operator=(CowVector&& other) noexcept {
+    if (this != &other) {
+        Unref();
+        shared_ = std::exchange(other.shared_, nullptr);
+    }
+    return *this;
+}
+
+template <typename T>
+const Vector<T>& CowVector<T>::Get() const noexcept {
+    static const Vector<T> empty;
+    return shared_ != nullptr ? shared_->values : empty;
+}
+
+template <typename T>
+Vector<T>& CowVector<T>::Mutate() {
+    if (shared_ == nullptr || IsShared()) {
+        Detach(Size());
+    }
+    return shared_->values;
+}
+
+// Копия сразу получает место под новый элемент, чтобы он не вызвал второго перевыделения
+template <typename T>
+template <typename... Args>
+T& CowVector<T>::EmplaceBack(Args&&... args) {
+    if (shared_ == nullptr || IsShared()) {
+        Detach(std::max<size_t>(Size() * 2, 1));
+    }
+    return shared_->values.EmplaceBack(std::forward<Args>(args)...);
+}
+
+template <typename T>
+void CowVector<T>::Clear() noexcept {
+    if (IsShared()) {
+        Unref();
+        shared_ = nullptr;
+    } else if (shared_ != nullptr) {
+        shared_->values.Clear();
+    }
+}
+
+template <typename T>
+Vector<T> CowVector<T>::Extract() {
+    if (shared_ == nullptr) {
+        return {};
+    }
+    Vector<T> result = IsShared() ? Vector<T>(shared_->values) : Vector<T>(std::move(shared_->values));
+    Unref();
+    shared_ = nullptr;
+    return result;
+}
+
+template <typename T>
+void CowVector<T>::Detach(size_t capacity) {
+    const size_t size = Size();
+    RawMemory<T> buffer(std::max(capacity, size));
+    if (size != 0) {
+        detail::CopyConstructN(shared_->values.Data(), size, buffer.GetAddress());
+    }
+    Vector<T> values;
+    values.AdoptBuffer(std::move(buffer), size);
+    Shared* detached = new Shared(std::move(values));
+    Unref();
+    shared_ = detached;
+}
+
+// Последний владелец должен видеть все записи, сделанные другими владельцами до отпускания
+template <typename T>
+void CowVector<T>::Unref() noexcept {
+    if (shared_ != nullptr && shared_->refs.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+        delete shared_;
+    }
+}
@@ -0,0 +1,421 @@
+#pragma once
+#include "vector.h"
+#include "index_iterator.h"
+
+#include <cstddef>
+#include <functional>
+#include <initializer_list>
+#include <iterator>
+#include <stdexcept>
+#include <utility>
+
+namespace detail {
+
+    // Двоичный поиск первого элемента, не меньшего key. Итерация выполняет одно сравнение и сдвиг
+    // через условное присваивание без ветвления, число итераций зависит только от n
+    template <typename K, typename Key, typename Compare>
+    size_t BranchlessLowerBound(const K* data, size_t n, const Key& key, const Compare& comp) {
+        size_t first = 0;
+        while (n > 1) {
+            const size_t half = n / 2;
+            first = comp(data[first + half - 1], key) ? first + half : first;
+            n -= half;
+        }
+        return first + (n == 1 && comp(data[first], key) ? 1 : 0);
+    }
+
+}  // namespace detail
+
+// Множество на отсортированном Vector: ключи лежат подряд, поиск двоичный без ветвлений, выделения памяти
+// на каждый элемент нет. Вставка и удаление сдвигают хвост, поэтому множество рассчитано на частое
+// чтение и редкую запись; массовое построение из диапазона сортирует его и убирает повторы за O(n log n)
+template <typename K, typename Compare = std::less<K>>
+class FlatSet {
+public:
+    using iterator = typename Vector<K>::const_iterator;
+    using const_iterator = iterator;
+
+    FlatSet() = default;
+    explicit FlatSet(const Compare& comp)
+            : comp_(comp) {
+    }
+    // Из повторяющихся ключей остаётся первый
+    template <typename InputIt, typename = detail::RequireInputIterator<InputIt>>
+    FlatSet(InputIt first, InputIt last, const Compare& comp = Compare());
+    FlatSet(std::initializer_list<K> keys, const Compare& comp = Compare())
+            : FlatSet(keys.begin(), keys.end(), comp) {
+    }
+
+    size_t Size() const noexcept {
+        return keys_.Size();
+    }
+
+    bool Empty() const noexcept {
+        return keys_.Size() == 0;
+    }
+
+    void Reserve(size_t capacity) {
+        keys_.Reserve(capacity);
+    }
+
+    void Clear() noexcept {
+        keys_.Clear();
+    }
+
+    const_iterator LowerBound(const K& key) const {
+        return keys_.begin() + LowerBoundIndex(key);
+    }
+
+    const_iterator Find(const K& key) const;
+
+    bool Contains(const K& key) const {
+        return Find(key) != end();
+    }
+
+    size_t Count(const K& key) const {
+        return Contains(key) ? 1 : 0;
+    }
+
+    // Возвращает позицию ключа и признак того, что он был вставлен
+    std::pair<iterator, bool> Insert(const K& key);
+    std::pair<iterator, bool> Insert(K&& key);
+    template <typename... Args>
+    std::pair<iterator, bool> Emplace(Args&&... args);
+
+    size_t Erase(const K& key);
+    iterator Erase(const_iterator pos);
+
+    // Отсортированные ключи
+    const Vector<K>& Keys() const noexcept {
+        return keys_;
+    }
+
+    const_iterator begin() const noexcept {
+        return keys_.begin();
+    }
+    const_iterator end() const noexcept {
+        return keys_.end();
+    }
+
+private:
+    Vector<K> keys_;
+    Compare comp_;
+
+    size_t LowerBoundIndex(const K& key) const {
+        return detail::BranchlessLowerBound(keys_.Data(), keys_.Size(), key, comp_);
+    }
+
+    bool Equivalent(const K& lhs, const K& rhs) const {
+        return !comp_(lhs, rhs) && !comp_(rhs, lhs);
+    }
+
+    template <typename Key>
+    std::pair<iterator, bool> InsertKey(Key&& key);
+};
+
+// Ассоциативный массив на двух отсортированных Vector: ключи отдельно от значений, чтобы поиск
+// проходил только по плотному массиву ключей и оставался в кэше. Итераторы разыменовываются
+// в пару ссылок std::pair<const K&, V&>
+template <typename K, typename V, typename Compare = std::less<K>>
+class FlatMap {
+    struct Entries {
+        Vector<K> keys;
+        Vector<V> values;
+
+        std::pair<const K&, V&> operator[](size_t index) noexcept {
+            return {keys[index], values[index]};
+        }
+
+        std::pair<const K&, const V&> operator[](size_t index) const noexcept {
+            return {keys[index], values[index]};
+        }
+    };
+
+public:
+    using iterator = IndexIterator<Entries, std::pair<K, V>>;
+    using const_iterator = IndexIterator<const Entries, std::pair<K, V>>;
+
+    FlatMap() = default;
+    explicit FlatMap(const Compare& comp)
+            : comp_(comp) {
+    }
+    // Из пар с повторяющимися ключами остаётся первая
+    template <typename InputIt, typename = detail::RequireInputIterator<InputIt>>
+    FlatMap(InputIt first, InputIt last, const Compare& comp = Compare());
+    FlatMap(std::initializer_list<std::pair<K, V>> entries, const Compare& comp = Compare())
+            : FlatMap(entries.begin(), entries.end(), comp) {
+    }
+
+    size_t Size() const noexcept {
+        return entries_.keys.Size();
+    }
+
+    bool Empty() const noexcept {
+        return Size() == 0;
+    }
+
+    void Reserve(size_t capacity);
+
+    void Clear() noexcept {
+        entries_.keys.Clear();
+        entries_.values.Clear();
+    }
+
+    iterator Find(const K& key);
+    const_iterator Find(const K& key) const;
+
+    bool Contains(const K& key) const {
+        return Find(key) != end();
+    }
+
+    size_t Count(const K& key) const {
+        return Contains(key) ? 1 : 0;
+    }
+
+    iterator LowerBound(const K& key) {
+        return {&entries_, LowerBoundIndex(key)};
+    }
+
+    const_iterator LowerBound(const K& key) const {
+        return {&entries_, LowerBoundIndex(key)};
+    }
+
+    // Бросает std::out_of_range, если ключа нет
+    V& At(const K& key);
+    const V& At(const K& key) const;
+
+    // Вставляет значение по умолчанию, если ключа нет
+    V& operator[](const K& key);
+
+    // Если ключ уже есть, ничего не меняет; значение создаётся из args только при вставке
+    template <typename... Args>
+    std::pair<iterator, bool> TryEmplace(const K& key, Args&&... args);
+    std::pair<iterator, bool> Insert(const K& key, const V& value) {
+        return TryEmplace(key, value);
+    }
+    std::pair<iterator, bool> Insert(const K& key, V&& value) {
+        return TryEmplace(key, std::move(value));
+    }
+    template <typename M>
+    std::pair<iterator, bool> InsertOrAssign(const K& key, M&& value);
+
+    size_t Erase(const K& key);
+    iterator Erase(const_iterator pos);
+
+    const Vector<K>& Keys() const noexcept {
+        return entries_.keys;
+    }
+
+    // Значения в порядке ключей; менять можно сами значения, но не их число
+    Vector<V>& Values() noexcept {
+        return entries_.values;
+    }
+
+    const Vector<V>& Values() const noexcept {
+        return entries_.values;
+    }
+
+    iterator begin() noexcept {
+        return {&entries_, 0};
+    }
+    iterator end() noexcept {
+        return {&entries_, Size()};
+    }
+    const_iterator begin() const noexcept {
+        return cbegin();
+    }
+    const_iterator end() const noexcept {
+        return cend();
+    }
+    const_iterator cbegin() const noexcept {
+        return {&entries_, 0};
+    }
+    const_iterator cend() const noexcept {
+        return {&entries_, Size()};
+    }
+
+private:
+    Entries entries_;
+    Compare comp_;
+
+    size_t LowerBoundIndex(const K& key) const {
+        return detail::BranchlessLowerBound(entries_.keys.Data(), entries_.keys.Size(), key, comp_);
+    }
+
+    // Индекс ключа или Size(), если его нет
+    size_t FindIndex(const K& key) const;
+};
+
+
+template <typename K, typename Compare>
+template <typename InputIt, typename>
+FlatSet<K, Compare>::FlatSet(InputIt first, InputIt last, const Compare& comp)
+        : comp_(comp) {
+    keys_.Append(first, last);
+    keys_.StableSort(comp_);
+    size_t unique = 0;
+    for (size_t i = 0; i < keys_.Size(); ++i) {
+        if (unique == 0 || !Equivalent(keys_[unique - 1], keys_[i])) {
+            if (unique != i) {
+                keys_[unique] = std::move(keys_[i]);
+            }
+            ++unique;
+        }
+    }
+    keys_.Erase(keys_.begin() + unique, keys_.end());
+}
+
+template <typename K, typename Compare>
+typename FlatSet<K, Compare>::const_iterator FlatSet<K, Compare>::Find(const K& key) const {
+    const size_t index = LowerBoundIndex(key);
+    return index != keys_.Size() && !comp_(key, keys_[index]) ? keys_.begin() + index : end();
+}
+
+template <typename K, typename Compare>
+template <typename Key>
+std::pair<typename FlatSet<K, Compare>::iterator, bool> FlatSet<K, Compare>::InsertKey(Key&& key) {
+    const size_t index = LowerBoundIndex(key);
+    if (index != keys_.Size() && !comp_(key, keys_[index])) {
+        return {keys_.begin() + index, false};
+    }
+    return {keys_.Insert(keys_.begin() + index, std::forward<Key>(key)), true};
+}
+
+template <typename K, typename Compare>
+std::pair<typename FlatSet<K, Compare>::iterator, bool> FlatSet<K, Compare>::Insert(const K& key) {
+    return InsertKey(key);
+}
+
+template <typename K, typename Compare>
+std::pair<typename FlatSet<K, Compare>::iterator, bool> FlatSet<K, Compare>::Insert(K&& key) {
+    return InsertKey(std::move(key));
+}
+
+// Позиция зависит от ключа, поэтому он создаётся заранее и потом переносится на место
+template <typename K, typename Compare>
+template <typename... Args>
+std::pair<typename FlatSet<K, Compare>::iterator, bool> FlatSet<K, Compare>::Emplace(Args&&... args) {
+    return InsertKey(K(std::forward<Args>(args)...));
+}
+
+template <typename K, typename Compare>
+size_t FlatSet<K, Compare>::Erase(const K& key) {
+    const auto pos = Find(key);
+    if (pos == end()) {
+        return 0;
+    }
+    keys_.Erase(pos);
+    return 1;
+}
+
+template <typename K, typename Compare>
+typename FlatSet<K, Compare>::iterator FlatSet<K, Compare>::Erase(const_iterator pos) {
+    return keys_.Erase(pos);
+}
+
+template <typename K, typename V, typename Compare>
+template <typename InputIt, typename>
+FlatMap<K, V, Compare>::FlatMap(InputIt first, InputIt last, const Compare& comp)
+        : comp_(comp) {
+    Vector<std::pair<K, V>> sorted;
+    sorted.Append(first, last);
+    sorted.StableSort([this](const std::pair<K, V>& lhs, const std::pair<K, V>& rhs) {
+        return comp_(lhs.first, rhs.first);
+    });
+    Reserve(sorted.Size());
+    for (auto& [key, value] : sorted) {
+        if (Empty() || comp_(entries_.keys[Size() - 1], key)) {
+            entries_.keys.PushBack(std::move(key));
+            entries_.values.PushBack(std::move(value));
+        }
+    }
+}
+
+template <typename K, typename V, typename Compare>
+void FlatMap<K, V, Compare>::Reserve(size_t capacity) {
+    entries_.keys.Reserve(capacity);
+    entries_.values.Reserve(capacity);
+}
+
+template <typename K, typename V, typename Compare>
+size_t FlatMap<K, V, Compare>::FindIndex(const K& key) const {
+    const size_t index = LowerBoundIndex(key);
+    return index != Size() && !comp_(key, entries_.keys[index]) ? index : Size();
+}
+
+template <typename K, typename V, typename Compare>
+typename FlatMap<K, V, Compare>::iterator FlatMap<K, V, Compare>::Find(const K& key) {
+    return {&entries_, FindIndex(key)};
+}
+
+template <typename K, typename V, typename Compare>
+typename FlatMap<K, V, Compare>::const_iterator FlatMap<K, V, Compare>::Find(const K& key) const {
+    return {&entries_, FindIndex(key)};
+}
+
+template <typename K, typename V, typename Compare>
+V& FlatMap<K, V, Compare>::At(const K& key) {
+    const size_t index = FindIndex(key);
+    if (index == Size()) {
+        throw std::out_of_range("FlatMap::At: key not found");
+    }
+    return entries_.values[index];
+}
+
+template <typename K, typename V, typename Compare>
+const V& FlatMap<K, V, Compare>::At(const K& key) const {
+    return const_cast<FlatMap&>(*this).At(key);
+}
+
+template <typename K, typename V, typename Compare>
+V& FlatMap<K, V, Compare>::operator[](const K& key) {
+    return (*TryEmplace(key).first).second;
+}
+
+// При исключении из конструктора значения вставленный ключ удаляется, и словарь остаётся прежним
+template <typename K, typename V, typename Compare>
+template <typename... Args>
+std::pair<typename FlatMap<K, V, Compare>::iterator, bool> FlatMap<K, V, Compare>::TryEmplace(const K& key,
+                                                                                             Args&&... args) {
+    const size_t index = LowerBoundIndex(key);
+    if (index != Size() && !comp_(key, entries_.keys[index])) {
+        return {{&entries_, index}, false};
+    }
+    entries_.keys.Insert(entries_.keys.begin() + index, key);
+    try {
+        entries_.values.Emplace(entries_.values.begin() + index, std::forward<Args>(args)...);
+    } catch (...) {
+        entries_.keys.Erase(entries_.keys.begin() + index);
+        throw;
+    }
+    return {{&entries_, index}, true};
+}
+
+template <typename K, typename V, typename Compare>
+template <typename M>
+std::pair<typename FlatMap<K, V, Compare>::iterator, bool> FlatMap<K, V, Compare>::InsertOrAssign(const K& key,
+                                                                                                 M&& value) {
+    auto result = TryEmplace(key, std::forward<M>(value));
+    if (!result.second) {
+        (*result.first).second = std::forward<M>(value);
+    }
+    return result;
+}
+
+template <typename K, typename V, typename Compare>
+size_t FlatMap<K, V, Compare>::Erase(const K& key) {
+    const size_t index = FindIndex(key);
+    if (index == Size()) {
+        return 0;
+    }
+    Erase(cbegin() + index);
+    return 1;
+}
+
+template <typename K, typename V, typename Compare>
+typename FlatMap<K, V, Compare>::iterator FlatMap<K, V, Compare>::Erase(const_iterator pos) {
+    const size_t index = pos.Index();
+    entries_.keys.Erase(entries_.keys.begin() + index);
+    entries_.values.Erase(entries_.values.begin() + index);
+    return {&entries_, index};
+}
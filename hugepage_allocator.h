@@ -0,0 +1,192 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <memory>
+#include <new>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+
+#if defined(__linux__)
+#include <linux/mempolicy.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+// Политика размещения страниц по узлам NUMA. nodes — битовая маска узлов (узлы 0..63);
+// Bind и Preferred для узла вне маски бросают std::invalid_argument
+struct NumaPolicy {
+    enum class Mode {
+        kDefault,     // страницы достаются узлу, первым их тронувшему
+        kBind,        // только узлы из маски
+        kPreferred,   // предпочтительно первый узел из маски
+        kInterleave,  // страницы по очереди раскладываются по узлам из маски
+    };
+
+    Mode mode = Mode::kDefault;
+    uint64_t nodes = 0;
+
+    static constexpr unsigned kMaxNodes = std::numeric_limits<uint64_t>::digits;
+
+    static NumaPolicy Bind(unsigned node) {
+        return {Mode::kBind, NodeMask(node)};
+    }
+
+    static NumaPolicy Preferred(unsigned node) {
+        return {Mode::kPreferred, NodeMask(node)};
+    }
+
+    static NumaPolicy Interleave(uint64_t nodes) noexcept {
+        return {Mode::kInterleave, nodes};
+    }
+
+    bool operator==(const NumaPolicy& other) const noexcept {
+        return mode == other.mode && nodes == other.nodes;
+    }
+
+    bool operator!=(const NumaPolicy& other) const noexcept {
+        return !(*this == other);
+    }
+
+private:
+    static uint64_t NodeMask(unsigned node) {
+        if (node >= kMaxNodes) {
+            throw std::invalid_argument("NumaPolicy: node " + std::to_string(node) + " is out of the 64-node mask");
+        }
+        return uint64_t{1} << node;
+    }
+};
+
+// Аллокатор для очень больших векторов. Блоки от threshold байт в Linux берутся через mmap:
+// сначала из заранее зарезервированных огромных страниц (MAP_HUGETLB), а если их нет — обычными страницами,
+// выровненными по kHugePageSize и помеченными MADV_HUGEPAGE для прозрачных огромных страниц.
+// К таким блокам до первого обращения применяется политика NUMA; ошибка mbind не считается фатальной,
+// так как политика лишь подсказка. Меньшие блоки и другие системы обслуживаются через operator new.
+// Способ выделения определяется размером блока, поэтому аллокаторы равны только при равных настройках
+template <typename T>
+class HugePageAllocator {
+public:
+    using value_type = T;
+    using propagate_on_container_move_assignment = std::true_type;
+    using propagate_on_container_swap = std::true_type;
+
+    static constexpr size_t kHugePageSize = size_t{2} << 20;
+    static constexpr size_t kDefaultThreshold = size_t{32} << 20;
+
+    explicit HugePageAllocator(NumaPolicy numa = {}, size_t threshold = kDefaultThreshold) noexcept
+            : numa_(numa), threshold_(threshold) {
+    }
+
+    template <typename U>
+    HugePageAllocator(const HugePageAllocator<U>& other) noexcept  // NOLINT(google-explicit-constructor)
+            : numa_(other.GetNumaPolicy()), threshold_(other.GetThreshold()) {
+    }
+
+    T* allocate(size_t n) {
+        if (n > std::numeric_limits<size_t>::max() / sizeof(T)) {
+            throw std::bad_array_new_length();
+        }
+        const size_t bytes = n * sizeof(T);
+#if defined(__linux__)
+        if (IsPageBacked(bytes)) {
+            return static_cast<T*>(MapHuge(RoundToHugePages(bytes)));
+        }
+#endif
+        return std::allocator<T>().allocate(n);
+    }
+
+    void deallocate(T* buf, size_t n) noexcept {
+#if defined(__linux__)
+        if (IsPageBacked(n * sizeof(T))) {
+            munmap(buf, RoundToHugePages(n * sizeof(T)));
+            return;
+        }
+#endif
+        std::allocator<T>().deallocate(buf, n);
+    }
+
+    NumaPolicy GetNumaPolicy() const noexcept {
+        return numa_;
+    }
+
+    size_t GetThreshold() const noexcept {
+        return threshold_;
+    }
+
+    template <typename U>
+    bool operator==(const HugePageAllocator<U>& other) const noexcept {
+        return numa_ == other.GetNumaPolicy() && threshold_ == other.GetThreshold();
+    }
+
+    template <typename U>
+    bool operator!=(const HugePageAllocator<U>& other) const noexcept {
+        return !(*this == other);
+    }
+
+private:
+    NumaPolicy numa_;
+    size_t threshold_;
+
+#if defined(__linux__)
+    bool IsPageBacked(size_t bytes) const noexcept {
+        return bytes >= threshold_;
+    }
+
+    static size_t RoundToHugePages(size_t bytes) noexcept {
+        return (bytes + kHugePageSize - 1) / kHugePageSize * kHugePageSize;
+    }
+
+    // bytes кратно kHugePageSize
+    void* MapHuge(size_t bytes) const {
+        void* buf = mmap(nullptr, bytes, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+        if (buf == MAP_FAILED) {
+            buf = MapAligned(bytes);
+            madvise(buf, bytes, MADV_HUGEPAGE);
+        }
+        ApplyNumaPolicy(buf, bytes);
+        return buf;
+    }
+
+    // Прозрачные огромные страницы выделяются только в выровненных по kHugePageSize участках,
+    // поэтому берётся запас в одну огромную страницу и лишнее по краям возвращается
+    static void* MapAligned(size_t bytes) {
+        const size_t mapped = bytes + kHugePageSize;
+        void* raw = mmap(nullptr, mapped, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+        if (raw == MAP_FAILED) {
+            throw std::bad_alloc();
+        }
+        const auto begin = reinterpret_cast<uintptr_t>(raw);
+        const uintptr_t aligned = (begin + kHugePageSize - 1) / kHugePageSize * kHugePageSize;
+        if (aligned != begin) {
+            munmap(raw, aligned - begin);
+        }
+        const size_t tail = begin + mapped - (aligned + bytes);
+        if (tail != 0) {
+            munmap(reinterpret_cast<void*>(aligned + bytes), tail);
+        }
+        return reinterpret_cast<void*>(aligned);
+    }
+
+    void ApplyNumaPolicy(void* buf, size_t bytes) const noexcept {
+        int mode = MPOL_DEFAULT;
+        switch (numa_.mode) {
+            case NumaPolicy::Mode::kDefault:
+                return;
+            case NumaPolicy::Mode::kBind:
+                mode = MPOL_BIND;
+                break;
+            case NumaPolicy::Mode::kPreferred:
+                mode = MPOL_PREFERRED;
+                break;
+            case NumaPolicy::Mode::kInterleave:
+                mode = MPOL_INTERLEAVE;
+                break;
+        }
+        unsigned long mask = numa_.nodes;
+        // Ядро читает maxnode - 1 бит маски
+        syscall(SYS_mbind, buf, bytes, mode, &mask, sizeof(mask) * 8 + 1, 0);
+    }
+#endif
+};
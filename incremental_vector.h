@@ -0,0 +1,313 @@
+#pragma once
+#include "vector.h"
+#include "vector_check.h"
+#include "index_iterator.h"
+
+#include <algorithm>
+#include <cstddef>
+#include <utility>
+
+// Вектор с постепенным переносом при росте. Заполненный буфер не переносится целиком: вектор выделяет
+// новый, кладёт туда добавляемый элемент, а старые элементы переносит понемногу — каждый следующий
+// PushBack переносит не больше нескольких элементов (не меньше Step; столько, чтобы перенос закончился
+// до заполнения нового буфера). Так худшее время одного PushBack ограничено, а не O(n).
+// Пока идёт перенос, элементы [migrated_, old_size_) лежат в старом буфере, остальные — в новом,
+// поэтому доступ по индексу стоит одного лишнего сравнения. Операции, меняющие ёмкость иначе
+// (Reserve, Resize, копирование), сначала завершают перенос
+template <typename T, size_t Step = 2, typename Growth = DoublingGrowth>
+class IncrementalVector {
+    static_assert(Step > 0, "migration step must be positive");
+
+public:
+    using iterator = IndexIterator<IncrementalVector, T>;
+    using const_iterator = IndexIterator<const IncrementalVector, T>;
+
+    IncrementalVector() = default;
+    explicit IncrementalVector(size_t size);
+    IncrementalVector(const IncrementalVector& other);
+    IncrementalVector(IncrementalVector&& other) noexcept;
+    ~IncrementalVector();
+
+    IncrementalVector& operator=(const IncrementalVector& other);
+    IncrementalVector& operator=(IncrementalVector&& other) noexcept;
+
+    void Swap(IncrementalVector& other) noexcept;
+
+    void Reserve(size_t capacity);
+    void Resize(size_t new_size);
+    void Clear() noexcept;
+
+    void PushBack(const T& value);
+    void PushBack(T&& value);
+    void PopBack() noexcept;
+
+    template <typename... Args>
+    T& EmplaceBack(Args&&... args);
+
+    // Переносит все оставшиеся элементы и освобождает старый буфер
+    void FinishMigration();
+
+    bool IsMigrating() const noexcept {
+        return old_.GetAddress() != nullptr;
+    }
+
+    size_t Size() const noexcept {
+        return size_;
+    }
+
+    size_t Capacity() const noexcept {
+        return data_.Capacity();
+    }
+
+    const T& operator[](size_t index) const noexcept {
+        return const_cast<IncrementalVector&>(*this)[index];
+    }
+
+    T& operator[](size_t index) noexcept {
+        VECTOR_CHECK(index < size_);
+        return IsInOld(index) ? old_[index] : data_[index];
+    }
+
+    iterator begin() noexcept {
+        return {this, 0};
+    }
+    iterator end() noexcept {
+        return {this, size_};
+    }
+    const_iterator begin() const noexcept {
+        return cbegin();
+    }
+    const_iterator end() const noexcept {
+        return cend();
+    }
+    const_iterator cbegin() const noexcept {
+        return {this, 0};
+    }
+    const_iterator cend() const noexcept {
+        return {this, size_};
+    }
+
+private:
+    // Новый буфер; ячейки [migrated_, old_size_) в нём пока пусты
+    RawMemory<T> data_;
+    // Старый буфер, пока идёт перенос. Индексы элементов в обоих буферах совпадают
+    RawMemory<T> old_;
+    size_t size_ = 0;
+    size_t migrated_ = 0;
+    size_t old_size_ = 0;
+    // Сколько элементов переносит один PushBack в текущем переносе
+    size_t step_ = Step;
+
+    bool IsInOld(size_t index) const noexcept {
+        return index >= migrated_ && index < old_size_;
+    }
+
+    // Переносит до count элементов из старого буфера; исходные элементы при исключении остаются на месте
+    void MigrateStep(size_t count);
+    void ReleaseOld() noexcept;
+    void DestroyAll() noexcept;
+};
+
+
+template <typename T, size_t Step, typename Growth>
+IncrementalVector<T, Step, Growth>::IncrementalVector(size_t size)
+        : data_(size) {
+    detail::ValueConstructN(data_.GetAddress(), size);
+    size_ = size;
+}
+
+template <typename T, size_t Step, typename Growth>
+IncrementalVector<T, Step, Growth>::IncrementalVector(const IncrementalVector& other)
+        : data_(other.size_) {
+    // Обе части other копируются по отдельности, переносить ничего не нужно
+    detail::CopyConstructN(other.data_.GetAddress(), other.migrated_, data_.GetAddress());
+    try {
+        detail::CopyConstructN(other.old_ + other.migrated_, other.old_size_ - other.migrated_,
+                               data_ + other.migrated_);
+        try {
+            detail::CopyConstructN(other.data_ + other.old_size_, other.size_ - other.old_size_,
+                                   data_ + other.old_size_);
+        } catch (...) {
+            detail::DestroyN(data_ + other.migrated_, other.old_size_ - other.migrated_);
+            throw;
+        }
+    } catch (...) {
+        detail::DestroyN(data_.GetAddress(), other.migrated_);
+        throw;
+    }
+    size_ = other.size_;
+}
+
+template <typename T, size_t Step, typename Growth>
+IncrementalVector<T, Step, Growth>::IncrementalVector(IncrementalVector&& other) noexcept
+        : data_(std::move(other.data_))
+        , old_(std::move(other.old_))
+        , size_(std::exchange(other.size_, 0))
+        , migrated_(std::exchange(other.migrated_, 0))
+        , old_size_(std::exchange(other.old_size_, 0))
+        , step_(std::exchange(other.step_, Step)) {
+}
+
+template <typename T, size_t Step, typename Growth>
+IncrementalVector<T, Step, Growth>::~IncrementalVector() {
+    DestroyAll();
+}
+
+template <typename T, size_t Step, typename Growth>
+IncrementalVector<T, Step, Growth>& IncrementalVector<T, Step, Growth>::operator=(const IncrementalVector& other) {
+    if (&other != this) {
+        IncrementalVector other_copy(other);
+        Swap(other_copy);
+    }
+    return *this;
+}
+
+template <typename T, size_t Step, typename Growth>
+IncrementalVector<T, Step, Growth>& IncrementalVector<T, Step, Growth>::operator=(IncrementalVector&& other) noexcept {
+    if (&other != this) {
+        IncrementalVector moved(std::move(other));
+        Swap(moved);
+    }
+    return *this;
+}
+
+template <typename T, size_t Step, typename Growth>
+void IncrementalVector<T, Step, Growth>::Swap(IncrementalVector& other) noexcept {
+    data_.Swap(other.data_);
+    old_.Swap(other.old_);
+    std::swap(size_, other.size_);
+    std::swap(migrated_, other.migrated_);
+    std::swap(old_size_, other.old_size_);
+    std::swap(step_, other.step_);
+}
+
+template <typename T, size_t Step, typename Growth>
+void IncrementalVector<T, Step, Growth>::DestroyAll() noexcept {
+    detail::DestroyN(data_.GetAddress(), migrated_);
+    detail::DestroyN(old_ + migrated_, old_size_ - migrated_);
+    detail::DestroyN(data_ + std::max(old_size_, migrated_), size_ - std::max(old_size_, migrated_));
+    size_ = 0;
+    ReleaseOld();
+}
+
+template <typename T, size_t Step, typename Growth>
+void IncrementalVector<T, Step, Growth>::ReleaseOld() noexcept {
+    RawMemory<T>().Swap(old_);
+    migrated_ = 0;
+    old_size_ = 0;
+}
+
+template <typename T, size_t Step, typename Growth>
+void IncrementalVector<T, Step, Growth>::MigrateStep(size_t count) {
+    const size_t n = std::min(count, old_size_ - migrated_);
+    detail::RelocateN(old_ + migrated_, n, data_ + migrated_);
+    migrated_ += n;
+    if (migrated_ == old_size_) {
+        ReleaseOld();
+    }
+}
+
+template <typename T, size_t Step, typename Growth>
+void IncrementalVector<T, Step, Growth>::FinishMigration() {
+    if (IsMigrating()) {
+        MigrateStep(old_size_ - migrated_);
+    }
+}
+
+template <typename T, size_t Step, typename Growth>
+void IncrementalVector<T, Step, Growth>::Reserve(size_t capacity) {
+    FinishMigration();
+    if (capacity <= data_.Capacity()) {
+        return;
+    }
+
+    RawMemory<T> new_buffer(capacity);
+    detail::RelocateN(data_.GetAddress(), size_, new_buffer.GetAddress());
+    data_.Swap(new_buffer);
+}
+
+template <typename T, size_t Step, typename Growth>
+void IncrementalVector<T, Step, Growth>::Resize(size_t new_size) {
+    FinishMigration();
+    if (new_size < size_) {
+        detail::DestroyN(data_ + new_size, size_ - new_size);
+    } else if (new_size > size_) {
+        Reserve(new_size);
+        detail::ValueConstructN(data_ + size_, new_size - size_);
+    }
+    size_ = new_size;
+}
+
+template <typename T, size_t Step, typename Growth>
+void IncrementalVector<T, Step, Growth>::Clear() noexcept {
+    DestroyAll();
+}
+
+template <typename T, size_t Step, typename Growth>
+void IncrementalVector<T, Step, Growth>::PushBack(const T& value) {
+    EmplaceBack(value);
+}
+
+template <typename T, size_t Step, typename Growth>
+void IncrementalVector<T, Step, Growth>::PushBack(T&& value) {
+    EmplaceBack(std::move(value));
+}
+
+template <typename T, size_t Step, typename Growth>
+void IncrementalVector<T, Step, Growth>::PopBack() noexcept {
+    VECTOR_CHECK(size_ != 0);
+    --size_;
+    if (IsInOld(size_)) {
+        std::destroy_at(old_ + size_);
+        old_size_ = size_;
+        if (migrated_ == old_size_) {
+            ReleaseOld();
+        }
+    } else {
+        std::destroy_at(data_ + size_);
+    }
+}
+
+// Элемент создаётся до любого переноса, так как аргументы могут ссылаться на ещё не перенесённые
+// элементы. Если перенос выбросит исключение, элемент уничтожается и вектор остаётся прежним
+template <typename T, size_t Step, typename Growth>
+template <typename... Args>
+T& IncrementalVector<T, Step, Growth>::EmplaceBack(Args&&... args) {
+    if (size_ == data_.Capacity()) {
+        RawMemory<T> new_buffer(Growth::NextCapacity(data_.Capacity(), size_ + 1, sizeof(T)));
+        T* element = new (new_buffer + size_) T(std::forward<Args>(args)...);
+        // Прошлый перенос может не успеть закончиться (например, при росте с одной ячейки до двух),
+        // тогда он завершается уже после создания элемента
+        try {
+            FinishMigration();
+        } catch (...) {
+            element->~T();
+            throw;
+        }
+        old_.Swap(data_);
+        data_.Swap(new_buffer);
+        old_size_ = size_;
+        migrated_ = 0;
+        ++size_;
+        if (old_size_ == 0) {
+            ReleaseOld();
+        } else {
+            // Перенос должен закончиться к моменту, когда новый буфер заполнится
+            const size_t pushes_left = data_.Capacity() - size_;
+            step_ = pushes_left != 0 ? std::max(Step, (old_size_ + pushes_left - 1) / pushes_left) : old_size_;
+        }
+        return *element;
+    }
+
+    T* element = new (data_ + size_) T(std::forward<Args>(args)...);
+    if (IsMigrating()) {
+        try {
+            MigrateStep(step_);
+        } catch (...) {
+            element->~T();
+            throw;
+        }
+    }
+    ++size_;
+    return *element;
+}
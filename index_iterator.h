@@ -0,0 +1,129 @@
+#pragma once
+#include <cstddef>
+#include <iterator>
+#include <memory>
+#include <type_traits>
+#include <utility>
+
+// Итератор произвольного доступа, хранящий контейнер и индекс и обращающийся к элементам через
+// operator[] контейнера. Подходит контейнерам без сплошного массива элементов (SegmentedVector)
+// и контейнерам, отдающим прокси-ссылки (SoAVector). Для константного обхода Owner — const-тип
+template <typename Owner, typename Value>
+class IndexIterator {
+public:
+    using iterator_category = std::random_access_iterator_tag;
+    using value_type = Value;
+    using difference_type = std::ptrdiff_t;
+    using reference = decltype(std::declval<Owner&>()[size_t{0}]);
+    using pointer = std::conditional_t<std::is_reference_v<reference>, std::remove_reference_t<reference>*, void>;
+
+    IndexIterator() = default;
+
+    IndexIterator(Owner* owner, size_t index) noexcept
+            : owner_(owner), index_(index) {
+    }
+
+    // Неконстантный итератор приводится к константному
+    template <typename OtherOwner,
+              typename = std::enable_if_t<std::is_same_v<const OtherOwner, Owner> && !std::is_same_v<OtherOwner, Owner>>>
+    IndexIterator(const IndexIterator<OtherOwner, Value>& other) noexcept  // NOLINT(google-explicit-constructor)
+            : owner_(other.GetOwner()), index_(other.Index()) {
+    }
+
+    Owner* GetOwner() const noexcept {
+        return owner_;
+    }
+
+    size_t Index() const noexcept {
+        return index_;
+    }
+
+    reference operator*() const noexcept {
+        return (*owner_)[index_];
+    }
+
+    template <typename R = reference, typename = std::enable_if_t<std::is_reference_v<R>>>
+    pointer operator->() const noexcept {
+        return std::addressof((*owner_)[index_]);
+    }
+
+    reference operator[](difference_type n) const noexcept {
+        return (*owner_)[index_ + n];
+    }
+
+    IndexIterator& operator++() noexcept {
+        ++index_;
+        return *this;
+    }
+
+    IndexIterator operator++(int) noexcept {
+        IndexIterator old = *this;
+        ++index_;
+        return old;
+    }
+
+    IndexIterator& operator--() noexcept {
+        --index_;
+        return *this;
+    }
+
+    IndexIterator operator--(int) noexcept {
+        IndexIterator old = *this;
+        --index_;
+        return old;
+    }
+
+    IndexIterator& operator+=(difference_type n) noexcept {
+        index_ += n;
+        return *this;
+    }
+
+    IndexIterator& operator-=(difference_type n) noexcept {
+        index_ -= n;
+        return *this;
+    }
+
+    friend IndexIterator operator+(IndexIterator it, difference_type n) noexcept {
+        return it += n;
+    }
+
+    friend IndexIterator operator+(difference_type n, IndexIterator it) noexcept {
+        return it += n;
+    }
+
+    friend IndexIterator operator-(IndexIterator it, difference_type n) noexcept {
+        return it -= n;
+    }
+
+    friend difference_type operator-(const IndexIterator& lhs, const IndexIterator& rhs) noexcept {
+        return static_cast<difference_type>(lhs.index_) - static_cast<difference_type>(rhs.index_);
+    }
+
+    friend bool operator==(const IndexIterator& lhs, const IndexIterator& rhs) noexcept {
+        return lhs.index_ == rhs.index_;
+    }
+
+    friend bool operator!=(const IndexIterator& lhs, const IndexIterator& rhs) noexcept {
+        return lhs.index_ != rhs.index_;
+    }
+
+    friend bool operator<(const IndexIterator& lhs, const IndexIterator& rhs) noexcept {
+        return lhs.index_ < rhs.index_;
+    }
+
+    friend bool operator<=(const IndexIterator& lhs, const IndexIterator& rhs) noexcept {
+        return lhs.index_ <= rhs.index_;
+    }
+
+    friend bool operator>(const IndexIterator& lhs, const IndexIterator& rhs) noexcept {
+        return lhs.index_ > rhs.index_;
+    }
+
+    friend bool operator>=(const IndexIterator& lhs, const IndexIterator& rhs) noexcept {
+        return lhs.index_ >= rhs.index_;
+    }
+
+private:
+    Owner* owner_ = nullptr;
+    size_t index_ = 0;
+};
@@ -1,10 +1,38 @@
 #include "vector.h"
+#include "realloc_allocator.h"
+#include "hugepage_allocator.h"
+#include "aligned_allocator.h"
+#include "small_vector.h"
+#include "soa_vector.h"
+#include "segmented_vector.h"
+#include "incremental_vector.h"
+#include "vector_io.h"
+#include "concurrent_vector.h"
+#include "sharded_vector.h"
+#include "flat_map.h"
+#include "cow_vector.h"
+#include "compact_vector.h"
 
+#include <atomic>
+#include <filesystem>
+#include <fstream>
 #include <iostream>
+#include <limits>
+#include <numeric>
+#include <sstream>
 #include <stdexcept>
 #include <string>
+#include <thread>
 #include <vector>
 
+#if defined(__unix__) || defined(__APPLE__)
+#include <csignal>
+#include <cstring>
+#include <fcntl.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#endif
+
 namespace {
 
 // "Магическое" число, используемое для отслеживания живости объекта
@@ -432,7 +460,7 @@ void Test6() {
     {
         Obj::ResetCounters();
         Vector<Obj> v;
-        auto* pos = v.Emplace(v.end(), Obj{1});
+        auto pos = v.Emplace(v.end(), Obj{1});
         assert(v.Size() == 1);
         assert(v.Capacity() >= v.Size());
         assert(&*pos == &v[0]);
@@ -447,7 +475,7 @@ void Test6() {
         Obj::ResetCounters();
         Vector<Obj> v;
         v.Reserve(SIZE);
-        auto* pos = v.Emplace(v.end(), Obj{1});
+        auto pos = v.Emplace(v.end(), Obj{1});
         assert(v.Size() == 1);
         assert(v.Capacity() >= v.Size());
         assert(&*pos == &v[0]);
@@ -494,7 +522,7 @@ void Test6() {
     {
         Obj::ResetCounters();
         Vector<Obj> v{SIZE};
-        auto* pos = v.Emplace(v.cbegin() + 1, ID, "Ivan"s);
+        auto pos = v.Emplace(v.cbegin() + 1, ID, "Ivan"s);
         assert(v.Size() == SIZE + 1);
         assert(v.Capacity() == SIZE * 2);
         assert(&*pos == &v[1]);
@@ -510,7 +538,7 @@ void Test6() {
     {
         Obj::ResetCounters();
         Vector<Obj> v{SIZE};
-        auto* pos = v.Emplace(v.cbegin() + v.Size(), ID, "Ivan"s);
+        auto pos = v.Emplace(v.cbegin() + v.Size(), ID, "Ivan"s);
         assert(v.Size() == SIZE + 1);
         assert(v.Capacity() == SIZE * 2);
         assert(&*pos == &v[SIZE]);
@@ -529,7 +557,7 @@ void Test6() {
         v.Reserve(SIZE * 2);
         const int old_num_moved = Obj::num_moved;
         assert(v.Capacity() == SIZE * 2);
-        auto* pos = v.Emplace(v.cbegin() + 3, ID, "Ivan"s);
+        auto pos = v.Emplace(v.cbegin() + 3, ID, "Ivan"s);
         assert(v.Size() == SIZE + 1);
         assert(&*pos == &v[3]);
         assert(v[3].id == ID);
@@ -545,7 +573,7 @@ void Test6() {
         Obj::ResetCounters();
         Vector<Obj> v{SIZE};
         v[2].id = ID;
-        auto* pos = v.Erase(v.cbegin() + 1);
+        auto pos = v.Erase(v.cbegin() + 1);
         assert((pos - v.begin()) == 1);
         assert(v.Size() == SIZE - 1);
         assert(v.Capacity() == SIZE);
@@ -558,84 +586,1892 @@ void Test6() {
     }
 }
 
-struct C {
-    C() noexcept {
-        ++def_ctor;
+namespace {
+
+    // Аллокатор с состоянием: считает выделения и различается по id
+    template <typename T>
+    struct TrackingAllocator {
+        using value_type = T;
+        using propagate_on_container_copy_assignment = std::true_type;
+        using propagate_on_container_move_assignment = std::true_type;
+        using propagate_on_container_swap = std::true_type;
+
+        explicit TrackingAllocator(int id = 0) noexcept
+                : id(id) {
+        }
+        template <typename U>
+        TrackingAllocator(const TrackingAllocator<U>& other) noexcept
+                : id(other.id) {
+        }
+
+        T* allocate(size_t n) {
+            ++num_allocations;
+            return static_cast<T*>(operator new(n * sizeof(T)));
+        }
+        void deallocate(T* p, size_t /*n*/) noexcept {
+            ++num_deallocations;
+            operator delete(p);
+        }
+
+        bool operator==(const TrackingAllocator& other) const noexcept {
+            return id == other.id;
+        }
+        bool operator!=(const TrackingAllocator& other) const noexcept {
+            return id != other.id;
+        }
+
+        int id = 0;
+
+        static inline int num_allocations = 0;
+        static inline int num_deallocations = 0;
+    };
+
+}  // namespace
+
+void Test7() {
+    const size_t SIZE = 100;
+    {
+        // Аллокатор без состояния не увеличивает размер вектора
+#if VECTOR_CHECK_LEVEL < 2
+        // На уровне проверок 2 буфер хранит ещё и номер для проверки итераторов
+        static_assert(sizeof(RawMemory<int>) == sizeof(int*) + sizeof(size_t));
+#endif
+        static_assert(sizeof(Vector<int>) < sizeof(PmrVector<int>));
     }
-    C(const C& /*other*/) noexcept {
-        ++copy_ctor;
+    {
+        alignas(std::max_align_t) unsigned char arena[4096];
+        std::pmr::monotonic_buffer_resource resource(arena, sizeof(arena), std::pmr::null_memory_resource());
+        PmrVector<int> v{&resource};
+        for (size_t i = 0; i < SIZE; ++i) {
+            v.PushBack(static_cast<int>(i));
+        }
+        assert(v.Size() == SIZE);
+        assert(v.GetAllocator().resource() == &resource);
+        const auto* first = reinterpret_cast<const unsigned char*>(&v[0]);
+        assert(first >= arena && first + SIZE * sizeof(int) <= arena + sizeof(arena));
+
+        PmrVector<int> v_copy(v);
+        assert(v_copy.GetAllocator().resource() == std::pmr::get_default_resource());
+        assert(v_copy[SIZE - 1] == static_cast<int>(SIZE - 1));
+
+        PmrVector<int> v_moved(std::move(v));
+        assert(v_moved.GetAllocator().resource() == &resource);
+        assert(v.Size() == 0);
+        assert(v_moved[SIZE / 2] == static_cast<int>(SIZE / 2));
+
+        // Аллокаторы различаются, поэтому элементы переносятся в память приёмника
+        v_copy = std::move(v_moved);
+        assert(v_copy.GetAllocator().resource() == std::pmr::get_default_resource());
+        assert(v_copy.Size() == SIZE);
+        assert(v_copy[SIZE - 1] == static_cast<int>(SIZE - 1));
     }
-    C(C&& /*other*/) noexcept {
-        ++move_ctor;
+    {
+        Obj::ResetCounters();
+        TrackingAllocator<Obj>::num_allocations = 0;
+        TrackingAllocator<Obj>::num_deallocations = 0;
+        {
+            Vector<Obj, TrackingAllocator<Obj>> v(SIZE, TrackingAllocator<Obj>{1});
+            Vector<Obj, TrackingAllocator<Obj>> other(SIZE / 2, TrackingAllocator<Obj>{2});
+            other = v;
+            assert(other.GetAllocator().id == 1);
+            assert(other.Size() == SIZE);
+
+            Vector<Obj, TrackingAllocator<Obj>> third(TrackingAllocator<Obj>{3});
+            third.Swap(other);
+            assert(third.GetAllocator().id == 1);
+            assert(other.GetAllocator().id == 3);
+            assert(third.Size() == SIZE);
+            assert(other.Size() == 0);
+
+            v = std::move(third);
+            assert(v.Size() == SIZE);
+            assert(third.Size() == 0);
+        }
+        assert(TrackingAllocator<Obj>::num_allocations == TrackingAllocator<Obj>::num_deallocations);
+        assert(Obj::GetAliveObjectCount() == 0);
     }
-    C& operator=(const C& other) noexcept {
-        if (this != &other) {
-            ++copy_assign;
+}
+
+namespace {
+
+    // Тип с нетривиальным перемещением, явно объявленный тривиально перемещаемым
+    struct Relocatable {
+        explicit Relocatable(int value)
+                : value(value) {
         }
-        return *this;
+        Relocatable(const Relocatable& other)
+                : value(other.value) {
+            ++num_copied;
+        }
+        Relocatable(Relocatable&& other) noexcept
+                : value(other.value) {
+            ++num_moved;
+        }
+        Relocatable& operator=(const Relocatable& other) = default;
+        Relocatable& operator=(Relocatable&& other) = default;
+        ~Relocatable() {
+            ++num_destroyed;
+        }
+
+        int value = 0;
+
+        static inline int num_copied = 0;
+        static inline int num_moved = 0;
+        static inline int num_destroyed = 0;
+    };
+
+}  // namespace
+
+template <>
+struct IsTriviallyRelocatable<Relocatable> : std::true_type {
+};
+
+void Test8() {
+    const size_t SIZE = 100;
+    static_assert(IsTriviallyRelocatableV<int>);
+    static_assert(IsTriviallyRelocatableV<std::unique_ptr<int>>);
+    static_assert(!IsTriviallyRelocatableV<Obj>);
+    {
+        Vector<Relocatable> v;
+        for (size_t i = 0; i < SIZE; ++i) {
+            v.EmplaceBack(static_cast<int>(i));
+        }
+        v.Reserve(SIZE * 4);
+        // Перенос в новый буфер не вызывает ни конструкторов, ни деструкторов
+        assert(Relocatable::num_copied == 0);
+        assert(Relocatable::num_moved == 0);
+        assert(Relocatable::num_destroyed == 0);
+        assert(v.Size() == SIZE);
+        assert(v[0].value == 0 && v[SIZE - 1].value == static_cast<int>(SIZE - 1));
     }
-    C& operator=(C&& /*other*/) noexcept {
-        ++move_assign;
-        return *this;
+    assert(Relocatable::num_destroyed == static_cast<int>(SIZE));
+    {
+        Vector<std::unique_ptr<int>> v;
+        for (size_t i = 0; i < SIZE; ++i) {
+            v.PushBack(std::make_unique<int>(static_cast<int>(i)));
+        }
+        v.Emplace(v.begin(), std::make_unique<int>(-1));
+        assert(*v[0] == -1);
+        assert(*v[SIZE] == static_cast<int>(SIZE - 1));
     }
-    ~C() {
-        ++dtor;
+}
+
+void Test9() {
+    using Allocator = ReallocatingAllocator<int>;
+    const size_t LARGE_SIZE = Allocator::kMmapThreshold / sizeof(int) * 2;
+    {
+        RawMemory<int> plain(16);
+        assert(!plain.TryExtend(32));
+        assert(plain.Capacity() == 16);
+
+        RawMemory<int, Allocator> memory(16);
+        memory[15] = 42;
+        assert(memory.TryExtend(1000));
+        assert(memory.Capacity() == 1000);
+        assert(memory[15] == 42);
+    }
+    {
+        Vector<int, Allocator> v;
+        for (size_t i = 0; i < LARGE_SIZE; ++i) {
+            v.PushBack(static_cast<int>(i));
+        }
+        assert(v.Size() == LARGE_SIZE);
+        v.Reserve(LARGE_SIZE * 2);
+        assert(v.Capacity() == LARGE_SIZE * 2);
+        assert(v[0] == 0 && v[LARGE_SIZE - 1] == static_cast<int>(LARGE_SIZE - 1));
+        for (size_t i = 0; i < LARGE_SIZE; ++i) {
+            assert(v[i] == static_cast<int>(i));
+        }
+    }
+    {
+        Vector<int, Allocator> v(4);
+        v[0] = 1;
+        v[3] = 4;
+        // Аргумент ссылается на элемент вектора, а буфер при вставке переезжает
+        v.PushBack(v[0]);
+        v.Emplace(v.begin() + 1, v[3]);
+        assert(v.Size() == 6);
+        assert(v[0] == 1 && v[1] == 4 && v[4] == 4 && v[5] == 1);
+    }
+}
+
+namespace {
+
+    // Пользовательская политика: ёмкость растёт на фиксированную величину
+    struct AdditiveGrowth {
+        static size_t NextCapacity(size_t capacity, size_t required, size_t /*element_size*/) noexcept {
+            return std::max(required, capacity + 10);
+        }
+    };
+
+}  // namespace
+
+void Test10() {
+    {
+        Vector<int> v;
+        v.PushBack(1);
+        assert(v.Capacity() == 1);
+        v.PushBack(2);
+        v.PushBack(3);
+        assert(v.Capacity() == 4);
+    }
+    {
+        Vector<int, std::allocator<int>, FactorOneAndHalfGrowth> v;
+        v.PushBack(1);
+        // Первый буфер занимает строку кэша целиком
+        assert(v.Capacity() == kCacheLineSize / sizeof(int));
+        while (v.Size() < v.Capacity()) {
+            v.PushBack(0);
+        }
+        v.EmplaceBack(0);
+        assert(v.Capacity() == kCacheLineSize / sizeof(int) * 3 / 2);
+        v.Emplace(v.begin(), -1);
+        assert(v[0] == -1 && v[1] == 1);
+        while (v.Capacity() * sizeof(int) < 16 * kPageSize) {
+            v.Insert(v.end(), 0);
+        }
+        // Крупные буферы занимают целое число страниц
+        assert(v.Capacity() * sizeof(int) % kPageSize == 0);
+    }
+    {
+        static_assert(GeometricGrowth<3, 2>::NextCapacity(0, 1, 1000) == 1);
+        static_assert(GeometricGrowth<3, 2>::NextCapacity(1, 2, 1000) == 2);
+        static_assert(GeometricGrowth<3, 2>::NextCapacity(4, 5, 1000) == 6);
     }
+    {
+        Obj::ResetCounters();
+        Vector<Obj, std::allocator<Obj>, AdditiveGrowth> v;
+        for (int i = 0; i < 25; ++i) {
+            v.EmplaceBack(i);
+        }
+        assert(v.Capacity() == 30);
+        assert(v[24].id == 24);
+    }
+    assert(Obj::GetAliveObjectCount() == 0);
+}
+
+void Test11() {
+    using namespace std::literals;
+    const size_t N = 4;
+    {
+        Obj::ResetCounters();
+        SmallVector<Obj, N> v;
+        assert(v.Capacity() == N);
+        assert(v.IsInline());
+        v.EmplaceBack(1);
+        v.PushBack(Obj{2});
+        v.Emplace(v.begin(), 0, "zero"s);
+        v.Insert(v.end(), Obj{3});
+        assert(v.IsInline());
+        assert(v.Size() == N);
+        assert(v[0].name == "zero"s && v[1].id == 1 && v[3].id == 3);
 
-    static void Reset() {
-        def_ctor = 0;
-        copy_ctor = 0;
-        move_ctor = 0;
-        copy_assign = 0;
-        move_assign = 0;
-        dtor = 0;
+        v.Insert(v.begin() + 2, v[0]);
+        assert(!v.IsInline());
+        assert(v.Capacity() == N * 2);
+        assert(v.Size() == N + 1);
+        assert(v[0].id == 0 && v[1].id == 1 && v[2].id == 0 && v[3].id == 2 && v[4].id == 3);
+
+        auto* pos = v.Erase(v.begin() + 2);
+        assert(pos->id == 2);
+        v.PopBack();
+        assert(v.Size() == N - 1);
+        assert(Obj::GetAliveObjectCount() == static_cast<int>(N - 1));
     }
+    assert(Obj::GetAliveObjectCount() == 0);
+    {
+        Obj::ResetCounters();
+        SmallVector<Obj, N> small(N);
+        small[N - 1].id = 42;
+        SmallVector<Obj, N> large(N * 4);
+        large[0].id = 7;
 
-    inline static size_t def_ctor = 0;
-    inline static size_t copy_ctor = 0;
-    inline static size_t move_ctor = 0;
-    inline static size_t copy_assign = 0;
-    inline static size_t move_assign = 0;
-    inline static size_t dtor = 0;
-};
+        SmallVector<Obj, N> small_copy(small);
+        assert(small_copy.IsInline() && small_copy[N - 1].id == 42);
 
-void Dump() {
-    using namespace std;
-    cerr << "Def ctors: "sv << C::def_ctor              //
-         << ", Copy ctors: "sv << C::copy_ctor          //
-         << ", Move ctors: "sv << C::move_ctor          //
-         << ", Copy assignments: "sv << C::copy_assign  //
-         << ", Move assignments: "sv << C::move_assign  //
-         << ", Dtors: "sv << C::dtor << endl;
+        SmallVector<Obj, N> moved(std::move(small));
+        assert(moved.IsInline() && moved[N - 1].id == 42);
+        assert(small.Size() == 0);
+
+        const auto* large_data = &large[0];
+        SmallVector<Obj, N> moved_large(std::move(large));
+        // Буфер в куче переходит целиком, без переноса элементов
+        assert(&moved_large[0] == large_data);
+
+        moved.Swap(moved_large);
+        assert(moved.Size() == N * 4 && moved[0].id == 7);
+        assert(moved_large.Size() == N && moved_large[N - 1].id == 42);
+
+        small_copy = moved;
+        assert(small_copy.Size() == N * 4 && small_copy[0].id == 7);
+
+        moved.Resize(1);
+        moved.Reserve(N * 8);
+        assert(moved.Capacity() == N * 8 && moved[0].id == 7);
+        assert(Obj::GetAliveObjectCount() == static_cast<int>(1 + N + N * 4));
+    }
+    assert(Obj::GetAliveObjectCount() == 0);
 }
 
-void Benchmark() {
-    using namespace std;
-    try {
-        const size_t NUM = 10;
-        C c;
-        {
-            cerr << "std::vector:"sv << endl;
-            C::Reset();
-            vector<C> v(NUM);
-            Dump();
-            v.push_back(c);
+void Test12() {
+    {
+        const std::vector<int> source{1, 2, 3, 4, 5, 6, 7, 8, 9, 10};
+        TrackingAllocator<int>::num_allocations = 0;
+        Vector<int, TrackingAllocator<int>> v;
+        v.PushBack(0);
+        v.Append(source.begin(), source.end());
+        // Одно выделение под первый элемент и одно под весь диапазон
+        assert(TrackingAllocator<int>::num_allocations == 2);
+        assert(v.Size() == source.size() + 1);
+        assert(v[0] == 0 && v[10] == 10);
+
+        v.Reserve(100);
+        v.Insert(v.begin() + 1, {-1, -2, -3});
+        v.Insert(v.begin(), 2, v[v.Size() - 1]);
+        v.Insert(v.end(), source.begin(), source.begin() + 2);
+        assert(TrackingAllocator<int>::num_allocations == 3);
+        const std::vector<int> expected{10, 10, 0, -1, -2, -3, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 1, 2};
+        assert(std::equal(v.begin(), v.end(), expected.begin(), expected.end()));
+
+        v.Append(v.begin(), v.begin() + 3);
+        assert(v.Size() == expected.size() + 3);
+        assert(v[v.Size() - 1] == 0);
+    }
+    {
+        std::istringstream input("3 4 5");
+        Vector<int> v;
+        v.PushBack(1);
+        v.PushBack(2);
+        v.Insert(v.begin() + 1, std::istream_iterator<int>(input), std::istream_iterator<int>());
+        const std::vector<int> expected{1, 3, 4, 5, 2};
+        assert(std::equal(v.begin(), v.end(), expected.begin(), expected.end()));
+    }
+    {
+        const size_t SIZE = 10;
+        Obj::ResetCounters();
+        Vector<Obj> v(SIZE);
+        v.Reserve(SIZE * 3);
+        for (size_t i = 0; i < SIZE; ++i) {
+            v[i].id = static_cast<int>(i);
         }
-        Dump();
-    } catch (...) {
+        const Obj obj{42};
+        // Вставляемый диапазон короче хвоста
+        v.Insert(v.begin() + 2, 3, obj);
+        assert(v.Size() == SIZE + 3);
+        assert(v[1].id == 1 && v[2].id == 42 && v[4].id == 42 && v[5].id == 2 && v[SIZE + 2].id == 9);
+        // Вставляемый диапазон длиннее хвоста
+        std::vector<Obj> source(4, obj);
+        v.Insert(v.end() - 2, source.begin(), source.end());
+        assert(v.Size() == SIZE + 7);
+        assert(v[SIZE].id == 7 && v[SIZE + 1].id == 42 && v[SIZE + 4].id == 42 && v[SIZE + 5].id == 8);
+        // Вставка с перевыделением
+        v.Insert(v.begin(), SIZE * 2, v[SIZE + 6]);
+        assert(v.Size() == SIZE * 3 + 7);
+        assert(v[0].id == 9 && v[SIZE * 2].id == 0);
+        assert(Obj::GetAliveObjectCount() == static_cast<int>(SIZE * 3 + 8 + source.size()));
     }
-    try {
-        const size_t NUM = 10;
-        C c;
-        {
-            cerr << "Vector:"sv << endl;
-            C::Reset();
-            Vector<C> v(NUM);
-            Dump();
-            v.PushBack(c);
+    assert(Obj::GetAliveObjectCount() == 0);
+}
+
+void Test13() {
+    const size_t SIZE = 1000;
+    {
+        Vector<uint8_t> v(SIZE, kDefaultInit);
+        assert(v.Size() == SIZE);
+        assert(v.Capacity() == SIZE);
+        std::fill(v.begin(), v.end(), uint8_t{7});
+
+        v.ResizeUninitialized(SIZE / 2);
+        assert(v.Size() == SIZE / 2);
+        v.ResizeUninitialized(SIZE * 2);
+        assert(v.Size() == SIZE * 2);
+        assert(v.Capacity() == SIZE * 2);
+        assert(v[SIZE / 2 - 1] == 7);
+    }
+    {
+        Obj::ResetCounters();
+        Vector<Obj> v(SIZE, kDefaultInit);
+        assert(Obj::num_default_constructed == static_cast<int>(SIZE));
+        v.ResizeDefaultInit(SIZE + 1);
+        assert(Obj::num_default_constructed == static_cast<int>(SIZE + 1));
+        v.ResizeDefaultInit(1);
+        assert(Obj::GetAliveObjectCount() == 1);
+    }
+    assert(Obj::GetAliveObjectCount() == 0);
+}
+
+void Test14() {
+    const size_t SIZE = 100;
+    {
+        Obj::ResetCounters();
+        Vector<Obj> v(SIZE);
+        for (size_t i = 0; i < SIZE; ++i) {
+            v[i].id = static_cast<int>(i);
+        }
+        auto pos = v.Erase(v.begin() + 10, v.begin() + 20);
+        assert(pos == v.begin() + 10);
+        assert(pos->id == 20);
+        assert(v.Size() == SIZE - 10);
+        assert(Obj::num_move_assigned == static_cast<int>(SIZE - 20));
+        assert(Obj::GetAliveObjectCount() == static_cast<int>(SIZE - 10));
+        assert(v.Erase(v.begin(), v.begin()) == v.begin());
+
+        const size_t removed = v.EraseIf([](const Obj& obj) {
+            return obj.id % 3 == 0;
+        });
+        assert(removed == 31);
+        assert(v.Size() == SIZE - 41);
+        assert(std::none_of(v.begin(), v.end(), [](const Obj& obj) {
+            return obj.id % 3 == 0;
+        }));
+        assert(Obj::GetAliveObjectCount() == static_cast<int>(SIZE - 41));
+    }
+    assert(Obj::GetAliveObjectCount() == 0);
+    {
+        Vector<std::unique_ptr<int>> v;
+        for (size_t i = 0; i < SIZE; ++i) {
+            v.PushBack(std::make_unique<int>(static_cast<int>(i)));
+        }
+        v.Erase(v.begin(), v.begin() + 5);
+        assert(*v[0] == 5);
+        assert(v.EraseIf([](const std::unique_ptr<int>& p) {
+            return *p % 2 == 0;
+        }) == 47);
+        assert(v.Size() == 48);
+        assert(*v[0] == 5 && *v[1] == 7 && *v[47] == 99);
+
+        // Исключение из предиката не теряет элементы
+        size_t calls = 0;
+        try {
+            v.EraseIf([&calls](const std::unique_ptr<int>& p) {
+                if (++calls == 10) {
+                    throw std::runtime_error("Oops");
+                }
+                return *p < 20;
+            });
+            assert(false && "Exception is expected");
+        } catch (const std::runtime_error&) {
+        }
+        assert(v.Size() == 48 - 8);
+        assert(*v[0] == 21 && *v[1] == 23 && *v[v.Size() - 1] == 99);
+    }
+}
+
+void Test15() {
+    const size_t SIZE = 10;
+    {
+        Obj::ResetCounters();
+        Vector<Obj> v(SIZE);
+        for (size_t i = 0; i < SIZE; ++i) {
+            v[i].id = static_cast<int>(i);
+        }
+        auto pos = v.EraseUnordered(v.begin() + 2);
+        assert(pos->id == 9);
+        assert(v.Size() == SIZE - 1);
+        assert(Obj::num_move_assigned == 1);
+        assert(Obj::GetAliveObjectCount() == static_cast<int>(SIZE - 1));
+
+        v.EraseUnordered(v.end() - 1);
+        assert(v.Size() == SIZE - 2);
+        assert(v[v.Size() - 1].id == 7);
+
+        // Хвост короче удаляемого диапазона
+        v.EraseUnordered(v.begin() + 3, v.begin() + 7);
+        assert(v.Size() == SIZE - 6);
+        assert(v[0].id == 0 && v[1].id == 1 && v[2].id == 9 && v[3].id == 7);
+        assert(Obj::GetAliveObjectCount() == static_cast<int>(SIZE - 6));
+    }
+    assert(Obj::GetAliveObjectCount() == 0);
+    {
+        Vector<int> v;
+        for (int i = 0; i < static_cast<int>(SIZE); ++i) {
+            v.PushBack(i);
+        }
+        v.EraseUnordered(v.begin(), v.begin() + 3);
+        const std::vector<int> expected{7, 8, 9, 3, 4, 5, 6};
+        assert(std::equal(v.begin(), v.end(), expected.begin(), expected.end()));
+
+        assert(v.EraseUnorderedIf([](int value) {
+            return value % 2 == 1;
+        }) == 4);
+        std::sort(v.begin(), v.end());
+        const std::vector<int> evens{4, 6, 8};
+        assert(std::equal(v.begin(), v.end(), evens.begin(), evens.end()));
+    }
+}
+
+namespace {
+
+    // Тривиально копируемый тип, конструктор которого может выбросить исключение
+    struct ThrowingPod {
+        ThrowingPod() = default;
+        explicit ThrowingPod(int value)
+                : value(value) {
+            if (value < 0) {
+                throw std::invalid_argument("negative");
+            }
+        }
+
+        int value = 0;
+    };
+
+}  // namespace
+
+void Test16() {
+    const size_t SIZE = 10;
+    {
+        Obj::ResetCounters();
+        Vector<Obj> v(SIZE);
+        v.Reserve(SIZE * 2);
+        const int old_num_moved = Obj::num_moved;
+        // Элемент создаётся прямо на месте, без временного объекта и присваивания из него
+        auto pos = v.Emplace(v.cbegin() + 3, Obj{1});
+        assert(pos->id == 1);
+        assert(v.Size() == SIZE + 1);
+        assert(Obj::num_moved == old_num_moved + 2);
+        assert(Obj::num_move_assigned == static_cast<int>(SIZE - 4));
+        assert(Obj::GetAliveObjectCount() == static_cast<int>(SIZE + 1));
+    }
+    assert(Obj::GetAliveObjectCount() == 0);
+    {
+        Relocatable::num_moved = 0;
+        Relocatable::num_copied = 0;
+        Vector<Relocatable> v;
+        v.Reserve(SIZE * 2);
+        for (size_t i = 0; i < SIZE; ++i) {
+            v.EmplaceBack(static_cast<int>(i));
+        }
+        v.Emplace(v.begin() + 2, -1);
+        v.Insert(v.begin(), v[SIZE]);
+        assert(v.Size() == SIZE + 2);
+        assert(v[0].value == static_cast<int>(SIZE - 1) && v[3].value == -1 && v[SIZE + 1].value == static_cast<int>(SIZE - 1));
+        // Хвост сдвигается через memmove, без конструкторов перемещения
+        assert(Relocatable::num_moved == 0);
+        assert(Relocatable::num_copied == 1);
+    }
+    {
+        Vector<ThrowingPod> v;
+        v.Reserve(SIZE * 2);
+        for (size_t i = 0; i < SIZE; ++i) {
+            v.EmplaceBack(static_cast<int>(i));
+        }
+        try {
+            v.Emplace(v.begin() + 1, -1);
+            assert(false && "Exception is expected");
+        } catch (const std::invalid_argument&) {
+        }
+        assert(v.Size() == SIZE);
+        for (size_t i = 0; i < SIZE; ++i) {
+            assert(v[i].value == static_cast<int>(i));
+        }
+    }
+}
+
+void Test17() {
+    struct GrowthTag;
+    struct CopyTag;
+    using Stats = VectorStats<GrowthTag>;
+    static_assert(sizeof(Vector<int>) == sizeof(RawMemory<int>) + sizeof(size_t));
+    Stats::Reset();
+    {
+        InstrumentedVector<int, GrowthTag> v;
+        for (int i = 0; i < 100; ++i) {
+            v.PushBack(i);
+        }
+        const auto stats = Stats::Get();
+        // Ёмкости 1, 2, 4, ..., 128
+        assert(stats.allocations == 8);
+        assert(stats.bytes_allocated == 255 * sizeof(int));
+        assert(stats.reallocations == 7);
+        assert(stats.elements_relocated == 127);
+        assert(stats.buffers_released == 0);
+    }
+    {
+        const auto stats = Stats::Get();
+        assert(stats.buffers_released == 1);
+        assert(stats.wasted_bytes == 28 * sizeof(int));
+    }
+    Stats::Reset();
+    {
+        InstrumentedVector<int, GrowthTag> v;
+        v.Reserve(10);
+        v.Resize(10);
+        InstrumentedVector<int, CopyTag> other(v.Size());
+        assert(Stats::Get().allocations == 1);
+        assert(Stats::Get().reallocations == 0);
+        assert(VectorStats<CopyTag>::Get().allocations == 1);
+    }
+    assert(Stats::Get().wasted_bytes == 0);
+    Stats::Reset();
+    assert(Stats::Get().allocations == 0);
+}
+
+void Test18() {
+    const size_t SIZE = 100;
+    {
+        Obj::ResetCounters();
+        Vector<Obj> v(SIZE);
+        const size_t capacity = v.Capacity();
+        v.Clear();
+        assert(v.Size() == 0 && v.Capacity() == capacity);
+        assert(Obj::GetAliveObjectCount() == 0);
+
+        v.Resize(10);
+        v.ShrinkToFit();
+        assert(v.Size() == 10 && v.Capacity() == 10);
+        assert(Obj::GetAliveObjectCount() == 10);
+        v.ShrinkToFit();
+        assert(v.Capacity() == 10);
+
+        v.Resize(0);
+        v.ShrinkToFit();
+        assert(v.Capacity() == 0 && v.Data() == nullptr);
+        v.PushBack(Obj{});
+        assert(v.Size() == 1);
+    }
+    assert(Obj::GetAliveObjectCount() == 0);
+    {
+        Vector<int, ReallocatingAllocator<int>> v;
+        for (size_t i = 0; i < SIZE; ++i) {
+            v.PushBack(static_cast<int>(i));
+        }
+        v.Resize(SIZE / 2);
+        v.ShrinkToFit();
+        assert(v.Capacity() == SIZE / 2);
+        for (size_t i = 0; i < SIZE / 2; ++i) {
+            assert(v[i] == static_cast<int>(i));
+        }
+    }
+    {
+        Obj::ResetCounters();
+        Vector<Obj> v(SIZE);
+        RawMemory<Obj> buffer = v.ReleaseBuffer();
+        assert(buffer.Capacity() == SIZE);
+        assert(v.Size() == 0 && v.Capacity() == 0);
+        assert(Obj::GetAliveObjectCount() == 0);
+        v.Resize(1);
+        assert(v.Size() == 1);
+    }
+    assert(Obj::GetAliveObjectCount() == 0);
+}
+
+void Test19() {
+    using Allocator = HugePageAllocator<int>;
+    const size_t LARGE_SIZE = Allocator::kHugePageSize / sizeof(int) * 3;
+    {
+        Allocator allocator(NumaPolicy::Interleave(1), Allocator::kHugePageSize);
+        Vector<int, Allocator> v(allocator);
+        for (size_t i = 0; i < LARGE_SIZE; ++i) {
+            v.PushBack(static_cast<int>(i));
+        }
+#if defined(__linux__)
+        // Большой блок выровнен по огромной странице
+        assert(reinterpret_cast<uintptr_t>(v.Data()) % Allocator::kHugePageSize == 0);
+#endif
+        for (size_t i = 0; i < LARGE_SIZE; ++i) {
+            assert(v[i] == static_cast<int>(i));
+        }
+
+        Vector<int, Allocator> copy(v);
+        assert(copy.GetAllocator() == allocator);
+        assert(copy.Size() == LARGE_SIZE && copy[LARGE_SIZE - 1] == static_cast<int>(LARGE_SIZE - 1));
+        v.ShrinkToFit();
+        assert(v.Capacity() == LARGE_SIZE);
+    }
+    {
+        Vector<int, Allocator> v(Allocator(NumaPolicy::Bind(0)));
+        v.Resize(10);
+        assert(v.Size() == 10 && v[9] == 0);
+        assert(Allocator(NumaPolicy::Bind(0)) != Allocator());
+    }
+    {
+        assert(NumaPolicy::Preferred(63).nodes == uint64_t{1} << 63);
+        for (unsigned node : {64u, 1000u}) {
+            try {
+                NumaPolicy::Bind(node);
+                assert(false && "Exception is expected");
+            } catch (const std::invalid_argument&) {
+            }
+        }
+    }
+}
+
+void Test20() {
+    {
+        AlignedVector<float> v;
+        for (int i = 0; i < 37; ++i) {
+            v.PushBack(static_cast<float>(i));
+            assert(reinterpret_cast<uintptr_t>(v.Data()) % kCacheLineSize == 0);
+        }
+        static_assert(AlignedAllocator<float>::PaddedSize(37) == 48);
+        static_assert(AlignedAllocator<float>::PaddedSize(48) == 48);
+        // Весь запас до границы шага принадлежит блоку
+        v.ShrinkToFit();
+        float* padding = v.Data() + v.Size();
+        for (size_t i = v.Size(); i < AlignedAllocator<float>::PaddedSize(v.Size()); ++i) {
+            *padding++ = 0.0f;
+        }
+        assert(v[36] == 36.0f);
+    }
+    {
+        AlignedVector<double, 256> v(3);
+        assert(reinterpret_cast<uintptr_t>(v.Data()) % 256 == 0);
+        AlignedVector<double, 256> copy(v);
+        assert(reinterpret_cast<uintptr_t>(copy.Data()) % 256 == 0);
+        static_assert(sizeof(AlignedVector<double, 256>) == sizeof(Vector<double>));
+    }
+}
+
+void Test21() {
+    const size_t SIZE = 1000;
+    {
+        Vector<int32_t> v(SIZE);
+        v.Fill(7);
+        assert(v.Count(7) == SIZE);
+        for (size_t i = 0; i < SIZE; ++i) {
+            v[i] = static_cast<int32_t>(i) - 500;
+        }
+        assert(v.Sum() == -500);
+        assert(v.MinMax() == std::make_pair(-500, 499));
+        assert(v.Find(0) == v.begin() + 500);
+        assert(v.Find(1000) == v.end());
+        assert(v.Count(3) == 1);
+        v.Transform([](int32_t x) {
+            return x * 2;
+        });
+        assert(v[SIZE - 1] == 998 && v.Sum() == -1000);
+
+        Vector<int32_t> copy(v);
+        assert(copy == v);
+        copy[SIZE - 1] = 0;
+        assert(copy != v);
+        copy.PopBack();
+        assert(copy != v);
+    }
+    {
+        Vector<int32_t> big(size_t{3} << 20);
+        big.Fill(std::numeric_limits<int32_t>::max());
+        // Сумма накапливается в 64 бита
+        assert(big.Sum() == int64_t{std::numeric_limits<int32_t>::max()} * (int64_t{3} << 20));
+    }
+    {
+        Vector<float> v(37);
+        for (size_t i = 0; i < v.Size(); ++i) {
+            v[i] = static_cast<float>(i) * 0.5f;
+        }
+        assert(v.Sum() == 333.0f);
+        assert(v.MinMax() == std::make_pair(0.0f, 18.0f));
+        assert(v.Find(2.5f) == v.begin() + 5);
+        Vector<float> other(v);
+        other[0] = -0.0f;
+        assert(other == v);
+    }
+    {
+        Vector<std::string> a;
+        a.PushBack("a");
+        Vector<std::string> b(a);
+        assert(a == b);
+        b[0] = "b";
+        assert(a != b);
+    }
+}
+
+namespace {
+
+    // Счётчик живых объектов, безопасный для конструирования из нескольких потоков
+    struct Counted {
+        Counted() noexcept {
+            ++alive;
+        }
+        explicit Counted(int value) noexcept
+                : value(value) {
+            ++alive;
+        }
+        Counted(const Counted& other)
+                : value(other.value) {
+            if (other.value < 0) {
+                throw std::runtime_error("Oops");
+            }
+            ++alive;
+        }
+        Counted& operator=(const Counted&) = default;
+        ~Counted() {
+            --alive;
+        }
+
+        int value = 0;
+
+        static inline std::atomic<int> alive{0};
+    };
+
+}  // namespace
+
+void Test22() {
+    const size_t SIZE = 1000;
+    const ParallelPolicy policy{4, 10};
+    {
+        const std::string value = "a string long enough to live on the heap";
+        Vector<std::string> v(SIZE, value, policy);
+        assert(v.Size() == SIZE);
+        assert(v.Count(value) == SIZE);
+
+        Vector<std::string> copy(v, policy);
+        assert(copy == v);
+
+        copy.Resize(SIZE * 3, policy);
+        assert(copy.Size() == SIZE * 3 && copy[SIZE * 3 - 1].empty() && copy[SIZE - 1] == value);
+        copy.Resize(SIZE / 2, policy);
+        assert(copy.Size() == SIZE / 2 && copy[SIZE / 2 - 1] == value);
+        copy.Clear(policy);
+        assert(copy.Size() == 0);
+    }
+    {
+        Vector<Counted> v(SIZE, policy);
+        assert(Counted::alive == static_cast<int>(SIZE));
+        for (size_t i = 0; i < SIZE; ++i) {
+            v[i].value = static_cast<int>(i);
+        }
+        v[SIZE * 3 / 4].value = -1;
+        try {
+            Vector<Counted> copy(v, policy);
+            assert(false && "Exception is expected");
+        } catch (const std::runtime_error&) {
+        }
+        // Построенные куски уничтожены, недостроенный убрал за собой uninitialized_copy_n
+        assert(Counted::alive == static_cast<int>(SIZE));
+
+        Vector<int> ints(SIZE * 10, policy);
+        assert(ints.Sum() == 0);
+        Vector<int> single(5, ParallelPolicy{1, 1});
+        assert(single.Size() == 5);
+    }
+    assert(Counted::alive == 0);
+}
+
+void Test23() {
+    const size_t SIZE = 100;
+    {
+        SoAVector<int, double, std::string> v;
+        for (size_t i = 0; i < SIZE; ++i) {
+            v.EmplaceBack(static_cast<int>(i), i * 0.5, std::to_string(i));
+        }
+        assert(v.Size() == SIZE && v.Capacity() >= SIZE);
+        auto [id, price, name] = v[10];
+        assert(id == 10 && price == 5.0 && name == "10");
+        price = 1.5;
+        assert(std::get<1>(v[10]) == 1.5);
+
+        // Столбец лежит непрерывно и обходится отдельно от остальных полей
+        auto ids = v.Column<0>();
+        assert(ids.Size() == SIZE);
+        int sum = 0;
+        for (int value : ids) {
+            sum += value;
+        }
+        assert(sum == static_cast<int>(SIZE * (SIZE - 1) / 2));
+
+        v.Insert(v.begin() + 1, -1, -1.0, std::string("inserted"));
+        assert(v.Size() == SIZE + 1 && std::get<2>(v[1]) == "inserted" && std::get<0>(v[2]) == 1);
+        // Аргументы ссылаются на элементы самого вектора
+        v.PushBack(std::get<0>(v[0]), std::get<1>(v[0]), std::get<2>(v[0]));
+        assert(std::get<2>(v[SIZE + 1]) == "0");
+
+        v.Erase(v.begin());
+        assert(std::get<0>(v[0]) == -1);
+        v.Erase(v.begin(), v.begin() + 10);
+        assert(v.Size() == SIZE - 9 && std::get<0>(v[0]) == 10);
+
+        SoAVector<int, double, std::string> copy(v);
+        assert(copy.Size() == v.Size() && std::get<2>(copy[5]) == std::get<2>(v[5]));
+        size_t count = 0;
+        for (auto it = copy.cbegin(); it != copy.cend(); ++it) {
+            ++count;
+        }
+        assert(count == copy.Size());
+
+        v.Resize(3);
+        assert(v.Size() == 3);
+        v.PopBack();
+        assert(v.Size() == 2);
+        copy = std::move(v);
+        assert(copy.Size() == 2 && v.Size() == 0);
+    }
+    {
+        // Аргументы ссылаются на другой столбец, уже сдвинутый к моменту создания поля
+        SoAVector<int, int> v;
+        v.Reserve(4);
+        v.PushBack(1, 10);
+        v.PushBack(2, 20);
+        v.Insert(v.begin(), std::get<1>(v[0]), std::get<0>(v[0]));
+        assert(v.Capacity() == 4);
+        assert(v[0] == std::make_tuple(10, 1) && v[1] == std::make_tuple(1, 10) && v[2] == std::make_tuple(2, 20));
+    }
+    {
+        Obj::ResetCounters();
+        SoAVector<int, Obj> v(SIZE);
+        for (size_t i = 0; i < SIZE; ++i) {
+            std::get<1>(v[i]).id = static_cast<int>(i);
+        }
+        std::get<1>(v[SIZE - 1]).throw_on_copy = true;
+        try {
+            SoAVector<int, Obj> copy(v);
+            assert(false && "Exception is expected");
+        } catch (const std::runtime_error&) {
+        }
+        assert(Obj::GetAliveObjectCount() == static_cast<int>(SIZE));
+        v.Reserve(SIZE * 2);
+        assert(std::get<1>(v[SIZE - 1]).id == static_cast<int>(SIZE - 1));
+        assert(Obj::num_copied == static_cast<int>(SIZE - 1));
+    }
+    assert(Obj::GetAliveObjectCount() == 0);
+}
+
+void Test24() {
+    const size_t SIZE = 10000;
+    static_assert(SegmentedVector<int>::kChunkSize == 1024);
+    static_assert(SegmentedVector<std::string>::kChunkSize * sizeof(std::string) <= kPageSize);
+    {
+        SegmentedVector<std::string, 64> v;
+        v.PushBack("first");
+        const std::string* first = &v[0];
+        for (size_t i = 1; i < SIZE; ++i) {
+            v.EmplaceBack(std::to_string(i));
+        }
+        // Рост не переносит элементы
+        assert(first == &v[0] && *first == "first");
+        assert(v.Size() == SIZE && v.ChunkCount() == (SIZE + 63) / 64);
+        assert(v[SIZE - 1] == std::to_string(SIZE - 1));
+
+        v.PushBack(v[0]);
+        assert(v[SIZE] == "first");
+
+        size_t count = 0;
+        for (const auto& value : v) {
+            count += !value.empty();
+        }
+        assert(count == SIZE + 1);
+        assert(v.end() - v.begin() == static_cast<std::ptrdiff_t>(SIZE + 1));
+        assert((v.begin() + 65)->size() == 2);
+
+        SegmentedVector<std::string, 64> copy(v);
+        assert(copy.Size() == v.Size() && copy[100] == v[100]);
+
+        v.Resize(100);
+        assert(v.Size() == 100);
+        v.ShrinkToFit();
+        assert(v.ChunkCount() == 2);
+        v.PopBack();
+        v.Clear();
+        assert(v.Size() == 0 && v.Capacity() == 128);
+    }
+    {
+        Obj::ResetCounters();
+        SegmentedVector<Obj, 4> v(10);
+        assert(v.ChunkCount() == 3);
+        Obj::default_construction_throw_countdown = 5;
+        try {
+            v.Resize(20);
+            assert(false && "Exception is expected");
+        } catch (const std::runtime_error&) {
+        }
+        assert(v.Size() == 10 && Obj::GetAliveObjectCount() == 10);
+        SegmentedVector<Obj, 4> moved(std::move(v));
+        assert(moved.Size() == 10 && v.Size() == 0);
+    }
+    assert(Obj::GetAliveObjectCount() == 0);
+}
+
+void Test25() {
+    const size_t SIZE = 1000;
+    {
+        Obj::ResetCounters();
+        IncrementalVector<Obj> v;
+        int max_moved_per_push = 0;
+        for (size_t i = 0; i < SIZE; ++i) {
+            const int moved_before = Obj::num_moved;
+            v.EmplaceBack(static_cast<int>(i));
+            max_moved_per_push = std::max(max_moved_per_push, Obj::num_moved - moved_before);
+            assert(v[i].id == static_cast<int>(i));
+            assert(v[i / 2].id == static_cast<int>(i / 2));
+        }
+        // Ни один PushBack не переносит больше двух элементов
+        assert(max_moved_per_push == 2);
+        assert(v.Size() == SIZE && v.Capacity() == 1024);
+        assert(!v.IsMigrating());
+        for (size_t i = 0; i < SIZE; ++i) {
+            assert(v[i].id == static_cast<int>(i));
+        }
+        assert(Obj::GetAliveObjectCount() == static_cast<int>(SIZE));
+    }
+    assert(Obj::GetAliveObjectCount() == 0);
+    {
+        IncrementalVector<std::string> v;
+        for (size_t i = 0; i < 65; ++i) {
+            v.PushBack(std::to_string(i));
+        }
+        assert(v.IsMigrating());
+        // Аргумент лежит в ещё не перенесённой части
+        v.PushBack(v[40]);
+        assert(v[65] == "40");
+
+        IncrementalVector<std::string> copy(v);
+        assert(!copy.IsMigrating() && copy.Size() == v.Size());
+        size_t i = 0;
+        for (const auto& value : copy) {
+            assert(value == v[i++]);
+        }
+
+        while (v.Size() > 30) {
+            v.PopBack();
+        }
+        assert(v.Size() == 30 && v[29] == "29");
+        v.FinishMigration();
+        assert(!v.IsMigrating() && v[0] == "0");
+
+        v.Reserve(1000);
+        assert(v.Capacity() == 1000 && v[29] == "29");
+        copy = std::move(v);
+        assert(copy.Size() == 30 && v.Size() == 0);
+        copy.Clear();
+        assert(copy.Size() == 0);
+    }
+    {
+        // Буфер заполнен, а прошлый перенос ещё не закончен: аргумент лежит в старом буфере
+        IncrementalVector<std::string> v;
+        v.PushBack(std::string(40, 'a'));
+        v.PushBack(std::string(40, 'b'));
+        v.PushBack(v[0]);
+        assert(v.Size() == 3 && v[2] == std::string(40, 'a'));
+        assert(v[0] == std::string(40, 'a') && v[1] == std::string(40, 'b'));
+    }
+}
+
+void Test26() {
+    struct Point {
+        int32_t x;
+        int32_t y;
+        double weight;
+    };
+    const size_t SIZE = 1000;
+    const std::string path = (std::filesystem::temp_directory_path() / "vector_io_test.bin").string();
+    {
+        Vector<Point> points;
+        for (size_t i = 0; i < SIZE; ++i) {
+            points.PushBack({static_cast<int32_t>(i), -static_cast<int32_t>(i), i * 0.25});
+        }
+        std::stringstream stream;
+        WriteVector(stream, points);
+        Vector<Point> loaded = ReadVector<Point>(stream);
+        assert(loaded.Size() == SIZE);
+        assert(loaded[SIZE - 1].x == static_cast<int32_t>(SIZE - 1) && loaded[SIZE - 1].weight == (SIZE - 1) * 0.25);
+
+        std::ofstream out(path, std::ios::binary);
+        VectorWriter<Point> writer(out);
+        for (size_t i = 0; i < SIZE; i += 100) {
+            writer.Write(points.Data() + i, 100);
+        }
+        writer.Write(Point{7, 7, 7.0});
+        writer.Finish();
+        assert(writer.Count() == SIZE + 1);
+    }
+    {
+        auto view = VectorView<Point>::Open(path);
+        assert(view.Size() == SIZE + 1);
+        assert(reinterpret_cast<uintptr_t>(view.Data()) % alignof(Point) == 0);
+        assert(view[500].x == 500 && view[500].y == -500 && view[SIZE].weight == 7.0);
+        int64_t sum = 0;
+        for (const Point& point : view) {
+            sum += point.x;
+        }
+        assert(sum == static_cast<int64_t>(SIZE * (SIZE - 1) / 2 + 7));
+
+        VectorView<Point> moved(std::move(view));
+        assert(moved.Size() == SIZE + 1 && view.Size() == 0);
+    }
+    {
+        try {
+            VectorView<int64_t>::Open(path);
+            assert(false && "Exception is expected");
+        } catch (const std::runtime_error&) {
+        }
+        std::stringstream garbage("definitely not a vector file, but long enough for a header");
+        try {
+            ReadVector<int>(garbage);
+            assert(false && "Exception is expected");
+        } catch (const std::runtime_error&) {
+        }
+
+        // Число элементов из заголовка проверяется до выделения памяти под них
+        std::stringstream written;
+        WriteVector(written, Vector<int>(4));
+        for (uint64_t count : {uint64_t{5}, uint64_t{1} << 40, std::numeric_limits<uint64_t>::max()}) {
+            std::string bytes = written.str();
+            const VectorFileHeader header = VectorFileHeader::For<int>(count);
+            std::memcpy(bytes.data(), &header, sizeof(header));
+            std::stringstream forged(bytes);
+            try {
+                ReadVector<int>(forged);
+                assert(false && "Exception is expected");
+            } catch (const std::runtime_error&) {
+            }
+        }
+    }
+    std::filesystem::remove(path);
+}
+
+void Test27() {
+    int deleter_calls = 0;
+    auto free_deleter = [&deleter_calls](auto* buffer, size_t) {
+        ++deleter_calls;
+        std::free(buffer);
+    };
+    {
+        // Чужой буфер принимается без копирования и освобождается своим deleter
+        const size_t SIZE = 16;
+        auto* payload = static_cast<uint8_t*>(std::malloc(SIZE));
+        for (size_t i = 0; i < SIZE; ++i) {
+            payload[i] = static_cast<uint8_t>(i);
+        }
+        AdoptingVector<uint8_t> v;
+        v.PushBack(42);
+        v.Adopt(payload, SIZE, SIZE, free_deleter);
+        assert(v.Size() == SIZE && v.Capacity() == SIZE && v.Data() == payload);
+        assert(v[SIZE - 1] == SIZE - 1);
+        assert(deleter_calls == 0);
+
+        // Рост переносит элементы в память аллокатора и возвращает чужой буфер
+        v.PushBack(100);
+        assert(deleter_calls == 1);
+        assert(v.Size() == SIZE + 1 && v[0] == 0 && v[SIZE] == 100);
+    }
+    {
+        // Release отдаёт и чужой, и собственный буфер вместе с элементами
+        auto* payload = static_cast<std::string*>(std::malloc(4 * sizeof(std::string)));
+        new (payload) std::string("adopted");
+        new (payload + 1) std::string("strings");
+        AdoptingVector<std::string> v;
+        v.Adopt(payload, 2, 4, free_deleter);
+        v.EmplaceBack("in place");
+        assert(v.Capacity() == 4 && v.Data() == payload);
+
+        ExternalBuffer<std::string> released = v.Release();
+        assert(v.Size() == 0 && v.Capacity() == 0);
+        assert(released.data == payload && released.size == 3 && released.capacity == 4);
+
+        AdoptingVector<std::string> other;
+        other.Adopt(std::move(released));
+        assert(other.Size() == 3 && other[2] == "in place");
+        assert(released.data == nullptr);
+        other.Clear();
+        assert(deleter_calls == 1);
+    }
+    assert(deleter_calls == 2);
+    {
+        Vector<int> v(10);
+        v[9] = 9;
+        ExternalBuffer<int> released = v.Release();
+        assert(released.size == 10 && released.data[9] == 9 && released.deleter);
+        released.deleter(released.data, released.capacity);
+
+        ExternalBuffer<int> empty = v.Release();
+        assert(empty.data == nullptr && !empty.deleter);
+
+        // Возможность принимать чужие буферы стоит указателя только тем, кто её выбрал
+        static_assert(sizeof(Vector<int>) == sizeof(int*) + 2 * sizeof(size_t) || VECTOR_CHECK_LEVEL >= 2);
+        static_assert(sizeof(AdoptingVector<int>) == sizeof(Vector<int>) + sizeof(void*));
+    }
+}
+
+namespace {
+
+    struct Event {
+        size_t producer = 0;
+        size_t sequence = 0;
+        std::string payload;
+
+        Event(size_t producer, size_t sequence)
+                : producer(producer), sequence(sequence), payload(std::to_string(sequence)) {
+            if (sequence == std::numeric_limits<size_t>::max()) {
+                throw std::runtime_error("bad event");
+            }
+        }
+    };
+
+}  // namespace
+
+void Test28() {
+    const size_t PRODUCERS = 4;
+    const size_t PER_PRODUCER = 5000;
+    {
+        ConcurrentVector<Event, 16> log;
+        std::atomic<bool> done = false;
+        std::atomic<bool> snapshot_ok = true;
+        // Читатель обходит снимки, пока производители пишут
+        std::thread reader([&] {
+            size_t last_size = 0;
+            while (!done.load()) {
+                const auto snapshot = log.Snapshot();
+                if (snapshot.Size() < last_size) {
+                    snapshot_ok = false;
+                }
+                last_size = snapshot.Size();
+                for (const Event& event : snapshot) {
+                    if (event.payload != std::to_string(event.sequence)) {
+                        snapshot_ok = false;
+                    }
+                }
+            }
+        });
+        std::vector<std::thread> producers;
+        for (size_t producer = 0; producer < PRODUCERS; ++producer) {
+            producers.emplace_back([&log, producer] {
+                for (size_t i = 0; i < PER_PRODUCER; ++i) {
+                    log.EmplaceBack(producer, i);
+                }
+            });
+        }
+        for (auto& thread : producers) {
+            thread.join();
+        }
+        done = true;
+        reader.join();
+        assert(snapshot_ok);
+        assert(log.Size() == PRODUCERS * PER_PRODUCER);
+
+        // Каждый производитель видит свои элементы в порядке добавления
+        std::vector<size_t> next(PRODUCERS, 0);
+        for (size_t i = 0; i < log.Size(); ++i) {
+            const Event& event = log[i];
+            assert(event.sequence == next[event.producer]);
+            ++next[event.producer];
+        }
+
+        // Добавление не двигает элементы
+        const Event* first = &log[0];
+        try {
+            log.EmplaceBack(0, std::numeric_limits<size_t>::max());
+            assert(false && "Exception is expected");
+        } catch (const std::runtime_error&) {
+        }
+        assert(log.Size() == PRODUCERS * PER_PRODUCER);
+        log.Reserve(log.Size() * 4);
+        log.EmplaceBack(0, PER_PRODUCER);
+        assert(&log[0] == first && log[log.Size() - 1].sequence == PER_PRODUCER);
+
+        log.Clear();
+        assert(log.Size() == 0);
+        log.PushBack(Event(1, 1));
+        assert(log.Size() == 1 && log[0].payload == "1");
+    }
+    {
+        ConcurrentVector<int> ints;
+        for (int i = 0; i < 10000; ++i) {
+            ints.PushBack(i);
+        }
+        assert(ints.Size() == 10000 && ints[9999] == 9999 && ints[ConcurrentVector<int>::kFirstSegmentSize] == 1024);
+    }
+}
+
+void Test29() {
+    const size_t SHARDS = 4;
+    const ParallelPolicy policy{4, 1};
+    {
+        ShardedVector<std::string> sharded(SHARDS);
+        assert(sharded.ShardCount() == SHARDS);
+        // Шарды разного размера, один пустой
+        std::vector<std::thread> workers;
+        for (size_t shard = 0; shard < SHARDS; ++shard) {
+            workers.emplace_back([&sharded, shard] {
+                for (size_t i = 0; i < shard * 100; ++i) {
+                    sharded.Shard(shard).PushBack(std::to_string(shard) + ":" + std::to_string(i));
+                }
+            });
+        }
+        for (auto& worker : workers) {
+            worker.join();
+        }
+        const size_t total = 100 + 200 + 300;
+        assert(sharded.Size() == total);
+
+        Vector<std::string> flat = sharded.Flatten(policy);
+        assert(flat.Size() == total && sharded.Size() == total);
+        assert(flat[0] == "1:0" && flat[99] == "1:99" && flat[100] == "2:0" && flat[total - 1] == "3:299");
+
+        const size_t capacity = sharded.Shard(3).Capacity();
+        Vector<std::string> merged = sharded.Merge(policy);
+        assert(merged == flat);
+        assert(sharded.Size() == 0 && sharded.Shard(3).Capacity() == capacity);
+    }
+    {
+        ShardedVector<int> sharded(SHARDS);
+        for (size_t shard = 0; shard < SHARDS; ++shard) {
+            for (int i = 0; i < 1000; ++i) {
+                sharded.Shard(shard).PushBack(i);
+            }
+        }
+        assert(sharded.Merge(policy).Sum() == SHARDS * 999 * 1000 / 2);
+        assert(sharded.Merge(policy).Size() == 0);
+    }
+    {
+        // Неудачное копирование не изменяет шарды и не оставляет живых копий
+        ShardedVector<Counted> sharded(SHARDS);
+        for (size_t shard = 0; shard < SHARDS; ++shard) {
+            sharded.Shard(shard).Resize(10);
+        }
+        sharded.Shard(2)[5].value = -1;
+        try {
+            sharded.Merge(policy);
+            assert(false && "Exception is expected");
+        } catch (const std::runtime_error&) {
+        }
+        assert(sharded.Size() == SHARDS * 10);
+        assert(Counted::alive == static_cast<int>(SHARDS * 10));
+    }
+    assert(Counted::alive == 0);
+}
+
+void Test30() {
+    const size_t SIZE = 100'000;
+    const ParallelPolicy policy{4, 1000};
+    uint64_t seed = 12345;
+    const auto next_random = [&seed] {
+        seed = seed * 6364136223846793005ULL + 1442695040888963407ULL;
+        return seed >> 33;
+    };
+    {
+        Vector<int> ints;
+        Vector<double> doubles;
+        for (size_t i = 0; i < SIZE; ++i) {
+            ints.PushBack(static_cast<int>(next_random()) - (1 << 30));
+            doubles.PushBack((static_cast<double>(next_random()) - (1u << 30)) / 7.0);
+        }
+        std::vector<int> expected_ints(ints.begin(), ints.end());
+        std::sort(expected_ints.begin(), expected_ints.end());
+        std::vector<double> expected_doubles(doubles.begin(), doubles.end());
+        std::sort(expected_doubles.begin(), expected_doubles.end());
+
+        Vector<int> parallel_ints = ints;
+        Vector<double> parallel_doubles = doubles;
+        ints.Sort();
+        doubles.Sort();
+        parallel_ints.Sort(policy);
+        parallel_doubles.Sort(policy);
+        assert(std::equal(ints.begin(), ints.end(), expected_ints.begin(), expected_ints.end()));
+        assert(std::equal(doubles.begin(), doubles.end(), expected_doubles.begin(), expected_doubles.end()));
+        assert(parallel_ints == ints && parallel_doubles == doubles);
+
+        ints.Sort(std::greater<>());
+        assert(std::is_sorted(ints.begin(), ints.end(), std::greater<>()));
+        ints.StableSort(policy);
+        assert(std::equal(ints.begin(), ints.end(), expected_ints.begin(), expected_ints.end()));
+    }
+    {
+        // Устойчивость: равные ключи сохраняют исходный порядок
+        struct Entry {
+            int key;
+            size_t index;
+        };
+        const auto by_key = [](const Entry& lhs, const Entry& rhs) {
+            return lhs.key < rhs.key;
+        };
+        Vector<Entry> entries;
+        for (size_t i = 0; i < SIZE; ++i) {
+            entries.PushBack({static_cast<int>(next_random() % 100), i});
+        }
+        Vector<Entry> parallel_entries = entries;
+        entries.StableSort(by_key);
+        parallel_entries.StableSort(policy, by_key);
+        for (size_t i = 1; i < SIZE; ++i) {
+            assert(entries[i - 1].key < entries[i].key
+                   || (entries[i - 1].key == entries[i].key && entries[i - 1].index < entries[i].index));
+            assert(parallel_entries[i].key == entries[i].key && parallel_entries[i].index == entries[i].index);
+        }
+    }
+    {
+        Vector<std::string> strings;
+        for (size_t i = 0; i < 5000; ++i) {
+            strings.PushBack("string number " + std::to_string(next_random() % 1000));
+        }
+        std::vector<std::string> expected(strings.begin(), strings.end());
+        std::stable_sort(expected.begin(), expected.end());
+        Vector<std::string> parallel_strings = strings;
+        strings.StableSort();
+        parallel_strings.Sort(ParallelPolicy{4, 100});
+        assert(std::equal(strings.begin(), strings.end(), expected.begin(), expected.end()));
+        assert(parallel_strings == strings);
+    }
+    {
+        // Свободной ёмкости хватает под буфер слияния, и сортировка ничего не выделяет
+        struct SortTag;
+        using Stats = VectorStats<SortTag>;
+        InstrumentedVector<int64_t, SortTag> v;
+        v.Reserve(2 * SIZE);
+        for (size_t i = 0; i < SIZE; ++i) {
+            v.PushBack(static_cast<int64_t>(next_random()) * (i % 2 == 0 ? 1 : -1));
+        }
+        Stats::Reset();
+        v.StableSort();
+        v.Sort(policy);
+        assert(Stats::Get().allocations == 0);
+        assert(std::is_sorted(v.begin(), v.end()));
+
+        v.Resize(1000);
+        v.ShrinkToFit();
+        v.StableSort(std::greater<>());
+        assert(Stats::Get().allocations == 2 && std::is_sorted(v.begin(), v.end(), std::greater<>()));
+    }
+    {
+        Vector<int> v;
+        for (int i = 0; i < 1000; ++i) {
+            v.PushBack((i * 7919) % 1000);
+        }
+        auto middle = v.Partition([](int value) {
+            return value % 2 == 0;
+        });
+        assert(middle - v.begin() == 500);
+        assert(std::all_of(v.begin(), middle, [](int value) {
+            return value % 2 == 0;
+        }));
+        v.NthElement(123);
+        assert(v[123] == 123);
+        Vector<int> single;
+        single.PushBack(5);
+        single.Sort(policy);
+        single.StableSort(policy);
+        assert(single[0] == 5);
+    }
+}
+
+void Test31() {
+    {
+        FlatSet<int> set{5, 1, 4, 1, 3, 5, 9};
+        assert(set.Size() == 5);
+        assert(std::is_sorted(set.begin(), set.end()));
+        assert(set.Contains(4) && !set.Contains(2) && set.Count(9) == 1);
+        assert(*set.LowerBound(2) == 3 && set.LowerBound(10) == set.end());
+
+        auto [pos, inserted] = set.Insert(2);
+        assert(inserted && *pos == 2 && set.Size() == 6);
+        assert(!set.Insert(2).second && set.Size() == 6);
+        assert(set.Emplace(7).second);
+        assert(set.Erase(1) == 1 && set.Erase(1) == 0);
+        assert(*set.Erase(set.Find(4)) == 5);
+        const std::vector<int> expected = {2, 3, 5, 7, 9};
+        assert(std::equal(set.begin(), set.end(), expected.begin(), expected.end()));
+
+        // Поиск совпадает с std::lower_bound на всех размерах, включая пустое множество
+        for (int size = 0; size < 40; ++size) {
+            std::vector<int> values;
+            for (int i = 0; i < size; ++i) {
+                values.push_back(i * 2);
+            }
+            FlatSet<int> odd_sizes(values.begin(), values.end());
+            for (int key = -1; key <= size * 2 + 1; ++key) {
+                const auto expected_pos = std::lower_bound(values.begin(), values.end(), key) - values.begin();
+                assert(odd_sizes.LowerBound(key) - odd_sizes.begin() == expected_pos);
+                assert(odd_sizes.Contains(key) == (key >= 0 && key % 2 == 0 && key < size * 2));
+            }
+        }
+    }
+    {
+        FlatSet<std::string, std::greater<>> names({"bob", "alice", "carol"}, std::greater<>());
+        assert(*names.begin() == "carol" && names.Keys()[2] == "alice");
+    }
+    {
+        FlatMap<std::string, int> map{{"one", 1}, {"two", 2}, {"three", 3}, {"one", 100}};
+        assert(map.Size() == 3);
+        assert(map.At("one") == 1 && map.At("three") == 3);
+        assert(std::is_sorted(map.Keys().begin(), map.Keys().end()));
+        try {
+            map.At("four");
+            assert(false && "Exception is expected");
+        } catch (const std::out_of_range&) {
+        }
+
+        map["four"] = 4;
+        ++map["one"];
+        assert(map.Size() == 4 && map.At("four") == 4 && map.At("one") == 2);
+        assert(!map.Insert("two", 20).second && map.At("two") == 2);
+        assert(!map.InsertOrAssign("two", 20).second && map.At("two") == 20);
+        assert(map.TryEmplace("five", 5).second);
+
+        int sum = 0;
+        for (auto [key, value] : map) {
+            sum += value;
+            value = 0;
+        }
+        assert(sum == 2 + 20 + 3 + 4 + 5);
+        assert(map.Values().Sum() == 0);
+
+        assert(map.Erase("two") == 1 && !map.Contains("two") && map.Size() == 4);
+        auto next = map.Erase(map.Find("four"));
+        assert((*next).first == "one");
+        const auto& const_map = map;
+        assert(const_map.Find("three") != const_map.end() && const_map.Find("zero") == const_map.end());
+
+        FlatMap<std::string, int> copy = map;
+        assert(copy.Size() == map.Size() && (*copy.begin()).first == (*map.begin()).first);
+    }
+    {
+        // Неудачное создание значения не оставляет ключа без значения
+        FlatMap<int, Obj> objects;
+        objects.TryEmplace(1);
+        Obj::ResetCounters();
+        Obj::default_construction_throw_countdown = 1;
+        try {
+            objects.TryEmplace(0);
+            assert(false && "Exception is expected");
+        } catch (const std::runtime_error&) {
+        }
+        assert(objects.Size() == 1 && objects.Keys().Size() == objects.Values().Size());
+        Obj::default_construction_throw_countdown = 0;
+    }
+}
+
+namespace {
+
+struct ThrowingAssign {
+    ThrowingAssign() = default;
+    ThrowingAssign(const ThrowingAssign&) = default;
+    ThrowingAssign& operator=(const ThrowingAssign&) noexcept(false) {
+        return *this;
+    }
+};
+
+struct ThrowingEqual {
+    int value = 0;
+
+    bool operator==(const ThrowingEqual& other) const noexcept(false) {
+        if (other.value < 0) {
+            throw std::runtime_error("comparison failed");
+        }
+        return value == other.value;
+    }
+};
+
+enum class Color { kRed = 1, kGreen };
+
+}  // namespace
+
+void Test32() {
+    // Гарантии исключений следуют из свойств типа
+    static_assert(noexcept(std::declval<Vector<int>&>().Fill(0)));
+    static_assert(!noexcept(std::declval<Vector<ThrowingAssign>&>().Fill(ThrowingAssign{})));
+    static_assert(noexcept(std::declval<const Vector<int>&>().Find(0)));
+    static_assert(!noexcept(std::declval<const Vector<ThrowingEqual>&>().Count(ThrowingEqual{})));
+    static_assert(noexcept(std::declval<Vector<int>&>().Erase({})));
+    static_assert(noexcept(std::declval<Vector<std::unique_ptr<int>>&>().EraseUnordered({})));
+    static_assert(noexcept(std::declval<Vector<std::string>&>().Erase({}, {})));
+    {
+        // Исключение из operator== доходит до вызывающего, а не завершает программу
+        Vector<ThrowingEqual> v;
+        v.PushBack({1});
+        v.PushBack({2});
+        assert(v.Find({2}) == v.begin() + 1 && v.Count({3}) == 0);
+        try {
+            v.Find({-1});
+            assert(false && "Exception is expected");
+        } catch (const std::runtime_error&) {
+        }
+    }
+    {
+        // Значения по умолчанию для чисел, указателей и перечислений обнуляются одним memset
+        Vector<double> doubles(5);
+        doubles[0] = 1.5;
+        doubles.Resize(2);
+        doubles.Resize(100);
+        assert(doubles[0] == 1.5 && doubles.Sum() == 1.5);
+        Vector<int*> pointers(17);
+        assert(std::all_of(pointers.begin(), pointers.end(), [](int* p) { return p == nullptr; }));
+        Vector<Color> colors(3);
+        assert(std::all_of(colors.begin(), colors.end(), [](Color c) { return static_cast<int>(c) == 0; }));
+        Vector<char> chars(10, 'x', kParallel);
+        assert(std::count(chars.begin(), chars.end(), 'x') == 10);
+    }
+    {
+        // Присваивание копированием в более короткий и более длинный вектор
+        Vector<int> longer(10, 7, kParallel);
+        Vector<int> shorter(3, 1, kParallel);
+        Vector<int> target = longer;
+        target = shorter;
+        assert(target.Size() == 3 && target.Sum() == 3 && target.Capacity() >= 10);
+        target = longer;
+        assert(target.Size() == 10 && target.Sum() == 70);
+
+        Vector<std::string> words(4, std::string(40, 'a'), kParallel);
+        Vector<std::string> other(2, std::string(40, 'b'), kParallel);
+        Vector<std::string> copy = words;
+        copy = other;
+        assert(copy.Size() == 2 && copy[1] == other[1]);
+        copy = words;
+        assert(copy.Size() == 4 && copy[3] == words[3]);
+    }
+    {
+        // Тривиально перемещаемые элементы удаляются сдвигом памяти
+        Vector<std::unique_ptr<int>> owners;
+        for (int i = 0; i < 5; ++i) {
+            owners.EmplaceBack(std::make_unique<int>(i));
+        }
+        auto next = owners.Erase(owners.begin() + 1);
+        assert(**next == 2 && owners.Size() == 4);
+        owners.Erase(owners.end() - 1);
+        assert(owners.Size() == 3 && *owners[0] == 0 && *owners[1] == 2 && *owners[2] == 3);
+    }
+}
+
+void Test33() {
+    {
+        Vector<std::string> table;
+        for (int i = 0; i < 100; ++i) {
+            table.PushBack(std::to_string(i));
+        }
+        const CowVector<std::string> original(std::move(table));
+        assert(original.Size() == 100 && !original.IsShared());
+
+        // Копия разделяет буфер и ничего не копирует
+        CowVector<std::string> snapshot = original;
+        assert(snapshot.IsShared() && original.IsShared());
+        assert(&snapshot[0] == &original[0] && snapshot.begin() == original.begin());
+
+        // Первое изменение отделяет снимок, исходный вектор не меняется
+        snapshot.Set(0, "changed");
+        assert(!snapshot.IsShared() && !original.IsShared());
+        assert(snapshot[0] == "changed" && original[0] == "0" && snapshot[99] == "99");
+        snapshot.PushBack("tail");
+        const std::string* detached = &snapshot[0];
+        snapshot.Mutate()[1] = "one";
+        assert(&snapshot[0] == detached && snapshot.Size() == 101 && original[1] == "1");
+
+        CowVector<std::string> moved = std::move(snapshot);
+        assert(snapshot.Empty() && moved[100] == "tail");
+        snapshot = original;
+        snapshot.Clear();
+        assert(snapshot.Empty() && original.Size() == 100);
+
+        // Extract копирует разделяемый буфер и переносит собственный
+        CowVector<std::string> shared = original;
+        Vector<std::string> copied = shared.Extract();
+        assert(copied.Size() == 100 && shared.Empty() && original.Size() == 100);
+        const std::string* own = &moved[0];
+        Vector<std::string> extracted = moved.Extract();
+        assert(&extracted[0] == own && moved.Empty());
+    }
+    {
+        CowVector<int> empty;
+        assert(empty.Size() == 0 && empty.begin() == empty.end() && empty.Extract().Size() == 0);
+        empty.PushBack(1);
+        empty.EmplaceBack(2);
+        CowVector<int> copy = empty;
+        copy.PopBack();
+        assert(empty.Size() == 2 && copy.Size() == 1 && copy[0] == 1);
+        copy = copy;
+        copy.Resize(4);
+        assert(copy.Get().Sum() == 1);
+    }
+    {
+        // Снимки раздаются потокам и меняются в них независимо
+        Vector<int> values(1000);
+        std::iota(values.begin(), values.end(), 0);
+        const CowVector<int> source(std::move(values));
+        std::vector<std::thread> threads;
+        std::vector<long long> sums(4);
+        for (size_t t = 0; t < sums.size(); ++t) {
+            threads.emplace_back([&sums, t, snapshot = source]() mutable {
+                if (t % 2 == 0) {
+                    snapshot.Set(0, 1000);
+                }
+                sums[t] = std::accumulate(snapshot.begin(), snapshot.end(), 0LL);
+            });
+        }
+        for (auto& thread : threads) {
+            thread.join();
+        }
+        assert(sums[0] == 500500 && sums[1] == 499500 && sums[2] == 500500 && sums[3] == 499500);
+        assert(source[0] == 0 && !source.IsShared());
+    }
+}
+
+namespace {
+
+#if VECTOR_CHECK_LEVEL >= 1 && (defined(__unix__) || defined(__APPLE__))
+// Выполняет action в дочернем процессе и проверяет, что проверка вектора завершила его через std::abort
+template <typename Action>
+bool FailsCheck(Action action) {
+    std::cout.flush();
+    const pid_t pid = fork();
+    if (pid == 0) {
+        const int null_fd = open("/dev/null", O_WRONLY);
+        dup2(null_fd, STDERR_FILENO);
+        action();
+        _exit(0);
+    }
+    int status = 0;
+    waitpid(pid, &status, 0);
+    return WIFSIGNALED(status) && WTERMSIG(status) == SIGABRT;
+}
+#endif
+
+}  // namespace
+
+void Test34() {
+    {
+        // Позиции проверяются сравнением указателей, без приведения к int
+        Vector<char> huge;
+        const size_t size = (size_t{1} << 31) + 16;
+        huge.ResizeUninitialized(size);
+        huge[size - 1] = 'z';
+        auto pos = huge.Emplace(huge.cend() - 1, 'y');
+        assert(pos - huge.begin() == static_cast<std::ptrdiff_t>(size - 1) && huge.Size() == size + 1);
+        huge.Erase(huge.cend() - 2);
+        assert(huge[size - 1] == 'z' && huge.Size() == size);
+    }
+#if VECTOR_CHECK_LEVEL >= 1 && (defined(__unix__) || defined(__APPLE__))
+    {
+        Vector<int> v(4);
+        Vector<int> other(4);
+        assert(!FailsCheck([&] { v[3] = 1; }));
+        assert(FailsCheck([&] { v[4] = 1; }));
+        assert(FailsCheck([&] { v.Erase(v.end()); }));
+        assert(FailsCheck([&] { v.Insert(other.begin(), 1); }));
+        assert(FailsCheck([&] { v.Erase(v.begin() + 3, v.begin() + 1); }));
+        assert(FailsCheck([] {
+            Vector<int> empty;
+            empty.PopBack();
+        }));
+    }
+#endif
+#if VECTOR_CHECK_LEVEL >= 2 && (defined(__unix__) || defined(__APPLE__))
+    {
+        // Итератор, переживший перевыделение, больше не разыменовывается
+        Vector<std::string> v(2);
+        auto it = v.begin();
+        *it = "first";
+        assert(FailsCheck([&] {
+            v.Reserve(100);
+            it->size();
+        }));
+        assert(FailsCheck([&] {
+            Vector<std::string> moved = std::move(v);
+            *it = "moved";
+        }));
+        assert(FailsCheck([&] {
+            v.Clear();
+            it->clear();
+        }));
+        assert(FailsCheck([&] {
+            auto end = v.cend();
+            v.PushBack("grow");
+            v.Erase(end);
+        }));
+
+        // Итератор за новым концом не оживает, когда вектор снова дорастёт до прежнего размера
+        Vector<int> shrinking(4);
+        shrinking.Reserve(8);
+        auto last = shrinking.begin() + 3;
+        assert(FailsCheck([&] {
+            shrinking.Erase(shrinking.begin());
+            shrinking.PushBack(5);
+            *last = 1;
+        }));
+        assert(FailsCheck([&] {
+            shrinking.PopBack();
+            shrinking.PushBack(5);
+            *last = 1;
+        }));
+        assert(FailsCheck([&] {
+            shrinking.Resize(2);
+            shrinking.Resize(4);
+            *last = 1;
+        }));
+        assert(!FailsCheck([&] {
+            auto next = shrinking.Erase(shrinking.begin());
+            *next = 1;
+        }));
+
+        // Без перевыделения итераторы остаются действительными
+        v.Reserve(10);
+        auto kept = v.begin();
+        v.PushBack("third");
+        assert(*kept == "first" && kept[2] == "third");
+        Vector<std::string>::const_iterator constant = kept;
+        assert(constant == v.cbegin() && v.end() - constant == 3);
+    }
+#endif
+}
+
+void Test35() {
+    static_assert(sizeof(CompactVector<int>) == sizeof(void*));
+    static_assert(sizeof(CompactVector<std::string>) == sizeof(void*));
+#if VECTOR_CHECK_LEVEL < 2
+    static_assert(sizeof(Vector<int>) == 3 * sizeof(void*));
+#endif
+    {
+        CompactVector<int> empty;
+        assert(empty.Size() == 0 && empty.Capacity() == 0 && empty.Data() == nullptr && empty.begin() == empty.end());
+        CompactVector<int> copy = empty;
+        copy.ShrinkToFit();
+        assert(copy.Empty());
+    }
+    {
+        // Элементы выровнены сильнее заголовка
+        struct alignas(32) Wide {
+            double values[4];
+        };
+        CompactVector<Wide> wide(3);
+        assert(reinterpret_cast<uintptr_t>(wide.Data()) % 32 == 0 && wide[2].values[3] == 0.0);
+    }
+    {
+        CompactVector<std::string> v;
+        for (int i = 0; i < 100; ++i) {
+            v.PushBack(std::to_string(i));
+        }
+        assert(v.Size() == 100 && v.Capacity() >= 100 && v[42] == "42");
+        v.Insert(v.begin(), "front");
+        v.Emplace(v.end(), 3, 'x');
+        v.Insert(v.cbegin() + 1, v[50]);
+        assert(v.Size() == 103 && v[0] == "front" && v[1] == "49" && v[2] == "0" && v.begin()[102] == "xxx");
+        auto next = v.Erase(v.cbegin() + 1);
+        assert(*next == "0" && v.Size() == 102);
+        v.PopBack();
+        v.Resize(10);
+        v.ShrinkToFit();
+        assert(v.Size() == 10 && v.Capacity() == 10 && v[9] == "8");
+
+        CompactVector<std::string> copy = v;
+        assert(copy.Size() == 10 && std::equal(copy.begin(), copy.end(), v.begin()));
+        CompactVector<std::string> moved = std::move(copy);
+        assert(copy.Empty() && moved[0] == "front");
+        copy = moved;
+        moved.Clear();
+        assert(moved.Empty() && moved.Capacity() == 10 && copy[5] == "4");
+        copy.Swap(moved);
+        assert(copy.Empty() && moved.Size() == 10);
+        moved.Resize(15);
+        assert(moved[14].empty());
+    }
+    {
+        // Исключение при росте не меняет вектор
+        CompactVector<Obj> objects(2);
+        Obj::ResetCounters();
+        Obj::default_construction_throw_countdown = 1;
+        try {
+            objects.EmplaceBack();
+            assert(false && "Exception is expected");
+        } catch (const std::runtime_error&) {
+        }
+        Obj::default_construction_throw_countdown = 0;
+        assert(objects.Size() == 2 && objects.Capacity() == 2);
+        objects.Reserve(64);
+        assert(objects.Size() == 2 && objects.Capacity() == 64);
+    }
+    {
+        CompactVector<char> bytes;
+        try {
+            bytes.Reserve(CompactVector<char>::kMaxSize + size_t{1});
+            assert(false && "Exception is expected");
+        } catch (const std::length_error&) {
         }
-        Dump();
-    } catch (...) {
+        assert(bytes.Capacity() == 0);
     }
 }
 
@@ -647,7 +2483,35 @@ int main() {
         Test4();
         Test5();
         Test6();
-        Benchmark();
+        Test7();
+        Test8();
+        Test9();
+        Test10();
+        Test11();
+        Test12();
+        Test13();
+        Test14();
+        Test15();
+        Test16();
+        Test17();
+        Test18();
+        Test19();
+        Test20();
+        Test21();
+        Test22();
+        Test23();
+        Test24();
+        Test25();
+        Test26();
+        Test27();
+        Test28();
+        Test29();
+        Test30();
+        Test31();
+        Test32();
+        Test33();
+        Test34();
+        Test35();
     } catch (const std::exception& e) {
         std::cerr << e.what() << std::endl;
     }
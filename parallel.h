@@ -0,0 +1,133 @@
+#pragma once
+#include <algorithm>
+#include <cstddef>
+#include <exception>
+#include <memory>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+// Настройки параллельных перегрузок Vector: операция делится на куски не меньше min_chunk элементов,
+// каждый кусок обрабатывает свой поток. num_threads == 0 означает число аппаратных потоков.
+// Потоки создаются на время вызова, поэтому выигрыш есть только на очень больших векторах
+struct ParallelPolicy {
+    size_t num_threads = 0;
+    size_t min_chunk = 1 << 16;
+
+    size_t ChunkCount(size_t count) const noexcept {
+        size_t threads = num_threads != 0 ? num_threads : std::thread::hardware_concurrency();
+        if (threads == 0) {
+            threads = 1;
+        }
+        const size_t max_chunks = min_chunk != 0 ? count / min_chunk : count;
+        return std::max<size_t>(1, std::min(threads, max_chunks));
+    }
+};
+
+inline const ParallelPolicy kParallel{};
+
+namespace detail {
+
+    // Вызывает fn(offset, n) для непересекающихся кусков [0, count), первый кусок — в текущем потоке.
+    // Если очередной поток создать не удалось (std::system_error, std::bad_alloc и т.п.), новые потоки
+    // больше не создаются, а этот и оставшиеся куски выполняются здесь же; исключение наружу не выходит.
+    // Возвращает для каждого куска исключение, которым он завершился
+    template <typename Fn>
+    std::vector<std::exception_ptr> ParallelChunks(size_t count, size_t chunks, Fn& fn) {
+        std::vector<std::exception_ptr> errors(chunks);
+        const auto run = [&](size_t chunk) noexcept {
+            const size_t begin = count * chunk / chunks;
+            const size_t end = count * (chunk + 1) / chunks;
+            try {
+                fn(begin, end - begin);
+            } catch (...) {
+                errors[chunk] = std::current_exception();
+            }
+        };
+
+        std::vector<std::thread> threads;
+        threads.reserve(chunks - 1);
+        size_t chunk = 1;
+        for (; chunk < chunks; ++chunk) {
+            try {
+                threads.emplace_back(run, chunk);
+            } catch (...) {
+                break;
+            }
+        }
+        for (; chunk < chunks; ++chunk) {
+            run(chunk);
+        }
+        run(0);
+        for (auto& thread : threads) {
+            thread.join();
+        }
+        return errors;
+    }
+
+    // Вызывает fn(offset, n) для chunks кусков [0, count) и пробрасывает первое из исключений кусков
+    template <typename Fn>
+    void ParallelFor(size_t count, size_t chunks, Fn fn) {
+        if (chunks <= 1) {
+            fn(size_t{0}, count);
+            return;
+        }
+        for (const auto& error : ParallelChunks(count, chunks, fn)) {
+            if (error) {
+                std::rethrow_exception(error);
+            }
+        }
+    }
+
+    // Создаёт объекты в [dest, dest + count) кусками: fn(offset, n) строит dest[offset, offset + n)
+    // и при исключении сам уничтожает то, что успел построить. Если какой-либо кусок не удался,
+    // уничтожаются только полностью построенные куски, и наружу выходит первое исключение
+    template <typename T, typename Fn>
+    void ParallelConstruct(T* dest, size_t count, const ParallelPolicy& policy, Fn fn) {
+        const size_t chunks = policy.ChunkCount(count);
+        if (chunks <= 1) {
+            fn(size_t{0}, count);
+            return;
+        }
+
+        const auto errors = ParallelChunks(count, chunks, fn);
+        std::exception_ptr first_error;
+        for (const auto& error : errors) {
+            if (error && !first_error) {
+                first_error = error;
+            }
+        }
+        if (!first_error) {
+            return;
+        }
+        for (size_t chunk = 0; chunk < chunks; ++chunk) {
+            if (!errors[chunk]) {
+                const size_t begin = count * chunk / chunks;
+                const size_t end = count * (chunk + 1) / chunks;
+                std::destroy_n(dest + begin, end - begin);
+            }
+        }
+        std::rethrow_exception(first_error);
+    }
+
+    template <typename T>
+    void ParallelDestroy(T* first, size_t count, const ParallelPolicy& policy) noexcept {
+        if constexpr (!std::is_trivially_destructible_v<T>) {
+            const size_t chunks = policy.ChunkCount(count);
+            auto destroy = [first](size_t offset, size_t n) noexcept {
+                std::destroy_n(first + offset, n);
+            };
+            if (chunks <= 1) {
+                destroy(0, count);
+                return;
+            }
+            try {
+                ParallelChunks(count, chunks, destroy);
+            } catch (...) {
+                // Служебная память кончилась до начала работы, уничтожаем всё здесь
+                destroy(0, count);
+            }
+        }
+    }
+
+}  // namespace detail
@@ -0,0 +1,111 @@
+#pragma once
+#include <cstdlib>
+#include <limits>
+#include <new>
+
+#if defined(__linux__)
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
+// Аллокатор поверх malloc/realloc/free, умеющий расширять блок на месте (см. RawMemory::TryExtend).
+// В Linux блоки от kMmapThreshold байт берутся напрямую через mmap и растут через mremap:
+// ядро переставляет страницы, а не копирует их, поэтому пик памяти не удваивается.
+// Способ выделения определяется размером блока, так что deallocate всегда знает, как освобождать
+template <typename T>
+class ReallocatingAllocator {
+    static_assert(alignof(T) <= alignof(std::max_align_t), "malloc does not guarantee alignment of T");
+
+public:
+    using value_type = T;
+
+    static constexpr size_t kMmapThreshold = size_t{4} << 20;
+
+    ReallocatingAllocator() noexcept = default;
+
+    template <typename U>
+    ReallocatingAllocator(const ReallocatingAllocator<U>& /*other*/) noexcept {
+    }
+
+    T* allocate(size_t n) {
+        const size_t bytes = BytesFor(n);
+#if defined(__linux__)
+        if (IsPageBacked(bytes)) {
+            void* buf = mmap(nullptr, RoundToPages(bytes), PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+            if (buf == MAP_FAILED) {
+                throw std::bad_alloc();
+            }
+            return static_cast<T*>(buf);
+        }
+#endif
+        void* buf = std::malloc(bytes);
+        if (buf == nullptr) {
+            throw std::bad_alloc();
+        }
+        return static_cast<T*>(buf);
+    }
+
+    void deallocate(T* buf, size_t n) noexcept {
+        const size_t bytes = n * sizeof(T);
+#if defined(__linux__)
+        if (IsPageBacked(bytes)) {
+            munmap(buf, RoundToPages(bytes));
+            return;
+        }
+#endif
+        std::free(buf);
+    }
+
+    // Расширяет блок buf с old_n до new_n элементов, возможно перенося его байты на новое место.
+    // Возвращает nullptr, если это невозможно без смены способа выделения; buf тогда не меняется
+    T* reallocate(T* buf, size_t old_n, size_t new_n) noexcept {
+        if (new_n > std::numeric_limits<size_t>::max() / sizeof(T)) {
+            return nullptr;
+        }
+        const size_t old_bytes = old_n * sizeof(T);
+        const size_t new_bytes = new_n * sizeof(T);
+        if (IsPageBacked(old_bytes) != IsPageBacked(new_bytes)) {
+            return nullptr;
+        }
+#if defined(__linux__)
+        if (IsPageBacked(new_bytes)) {
+            void* new_buf = mremap(buf, RoundToPages(old_bytes), RoundToPages(new_bytes), MREMAP_MAYMOVE);
+            return new_buf != MAP_FAILED ? static_cast<T*>(new_buf) : nullptr;
+        }
+#endif
+        return static_cast<T*>(std::realloc(buf, new_bytes));
+    }
+
+    template <typename U>
+    bool operator==(const ReallocatingAllocator<U>& /*other*/) const noexcept {
+        return true;
+    }
+
+    template <typename U>
+    bool operator!=(const ReallocatingAllocator<U>& /*other*/) const noexcept {
+        return false;
+    }
+
+private:
+    static size_t BytesFor(size_t n) {
+        if (n > std::numeric_limits<size_t>::max() / sizeof(T)) {
+            throw std::bad_array_new_length();
+        }
+        return n * sizeof(T);
+    }
+
+    static bool IsPageBacked([[maybe_unused]] size_t bytes) noexcept {
+#if defined(__linux__)
+        return bytes >= kMmapThreshold;
+#else
+        return false;
+#endif
+    }
+
+#if defined(__linux__)
+    static size_t RoundToPages(size_t bytes) noexcept {
+        static const size_t page_size = static_cast<size_t>(sysconf(_SC_PAGESIZE));
+        return (bytes + page_size - 1) / page_size * page_size;
+    }
+#endif
+};
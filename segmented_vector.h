@@ -0,0 +1,253 @@
+#pragma once
+#include "vector.h"
+#include "vector_check.h"
+#include "index_iterator.h"
+
+#include <cstddef>
+#include <type_traits>
+#include <utility>
+
+namespace detail {
+
+// Наибольшая степень двойки, при которой блок укладывается в страницу (но не меньше одного элемента)
+constexpr size_t DefaultChunkSize(size_t element_size) noexcept {
+    size_t chunk_size = 1;
+    while (chunk_size * 2 * element_size <= kPageSize) {
+        chunk_size *= 2;
+    }
+    return chunk_size;
+}
+
+}  // namespace detail
+
+// Вектор из цепочки блоков RawMemory по ChunkSize элементов. Рост добавляет новый блок и никогда
+// не переносит элементы, поэтому адреса элементов стабильны, а добавление в конец выполняется
+// за O(1) без пауз на перевыделение. Доступ по индексу идёт через плоский массив блоков:
+// номер блока и смещение в нём вычисляются сдвигом и маской
+template <typename T, size_t ChunkSize = detail::DefaultChunkSize(sizeof(T))>
+class SegmentedVector {
+    static_assert(ChunkSize > 0 && (ChunkSize & (ChunkSize - 1)) == 0, "chunk size must be a power of two");
+
+public:
+    static constexpr size_t kChunkSize = ChunkSize;
+
+    using iterator = IndexIterator<SegmentedVector, T>;
+    using const_iterator = IndexIterator<const SegmentedVector, T>;
+
+    SegmentedVector() = default;
+    explicit SegmentedVector(size_t size);
+    SegmentedVector(const SegmentedVector& other);
+    SegmentedVector(SegmentedVector&& other) noexcept;
+    ~SegmentedVector();
+
+    SegmentedVector& operator=(const SegmentedVector& other);
+    SegmentedVector& operator=(SegmentedVector&& other) noexcept;
+
+    void Swap(SegmentedVector& other) noexcept;
+
+    void Reserve(size_t capacity);
+    void Resize(size_t new_size);
+    void Clear() noexcept;
+    // Освобождает блоки целиком за последним элементом
+    void ShrinkToFit() noexcept;
+
+    void PushBack(const T& value);
+    void PushBack(T&& value);
+    void PopBack() noexcept;
+
+    template <typename... Args>
+    T& EmplaceBack(Args&&... args);
+
+    size_t Size() const noexcept {
+        return size_;
+    }
+
+    size_t Capacity() const noexcept {
+        return chunks_.Size() * ChunkSize;
+    }
+
+    size_t ChunkCount() const noexcept {
+        return chunks_.Size();
+    }
+
+    const T& operator[](size_t index) const noexcept {
+        return const_cast<SegmentedVector&>(*this)[index];
+    }
+
+    T& operator[](size_t index) noexcept {
+        VECTOR_CHECK(index < size_);
+        return chunks_[index / ChunkSize][index % ChunkSize];
+    }
+
+    iterator begin() noexcept {
+        return {this, 0};
+    }
+    iterator end() noexcept {
+        return {this, size_};
+    }
+    const_iterator begin() const noexcept {
+        return cbegin();
+    }
+    const_iterator end() const noexcept {
+        return cend();
+    }
+    const_iterator cbegin() const noexcept {
+        return {this, 0};
+    }
+    const_iterator cend() const noexcept {
+        return {this, size_};
+    }
+
+private:
+    Vector<RawMemory<T>> chunks_;
+    size_t size_ = 0;
+
+    // Адрес ячейки index, которая может быть ещё не занята
+    T* Slot(size_t index) noexcept {
+        return chunks_[index / ChunkSize].GetAddress() + index % ChunkSize;
+    }
+
+    // Уничтожает элементы [from, size_) по блокам
+    void DestroyFrom(size_t from) noexcept;
+};
+
+
+template <typename T, size_t ChunkSize>
+SegmentedVector<T, ChunkSize>::SegmentedVector(size_t size) {
+    Resize(size);
+}
+
+template <typename T, size_t ChunkSize>
+SegmentedVector<T, ChunkSize>::SegmentedVector(const SegmentedVector& other) {
+    Reserve(other.size_);
+    try {
+        for (; size_ < other.size_; ++size_) {
+            new (Slot(size_)) T(other[size_]);
+        }
+    } catch (...) {
+        DestroyFrom(0);
+        throw;
+    }
+}
+
+template <typename T, size_t ChunkSize>
+SegmentedVector<T, ChunkSize>::SegmentedVector(SegmentedVector&& other) noexcept
+        : chunks_(std::move(other.chunks_)), size_(std::exchange(other.size_, 0)) {
+}
+
+template <typename T, size_t ChunkSize>
+SegmentedVector<T, ChunkSize>::~SegmentedVector() {
+    DestroyFrom(0);
+}
+
+template <typename T, size_t ChunkSize>
+SegmentedVector<T, ChunkSize>& SegmentedVector<T, ChunkSize>::operator=(const SegmentedVector& other) {
+    if (&other != this) {
+        SegmentedVector other_copy(other);
+        Swap(other_copy);
+    }
+    return *this;
+}
+
+template <typename T, size_t ChunkSize>
+SegmentedVector<T, ChunkSize>& SegmentedVector<T, ChunkSize>::operator=(SegmentedVector&& other) noexcept {
+    if (&other != this) {
+        DestroyFrom(0);
+        chunks_ = std::move(other.chunks_);
+        size_ = std::exchange(other.size_, 0);
+    }
+    return *this;
+}
+
+template <typename T, size_t ChunkSize>
+void SegmentedVector<T, ChunkSize>::Swap(SegmentedVector& other) noexcept {
+    chunks_.Swap(other.chunks_);
+    std::swap(size_, other.size_);
+}
+
+template <typename T, size_t ChunkSize>
+void SegmentedVector<T, ChunkSize>::DestroyFrom(size_t from) noexcept {
+    if constexpr (!std::is_trivially_destructible_v<T>) {
+        for (size_t index = from; index < size_;) {
+            const size_t chunk_end = std::min(size_, (index / ChunkSize + 1) * ChunkSize);
+            detail::DestroyN(Slot(index), chunk_end - index);
+            index = chunk_end;
+        }
+    }
+    size_ = std::min(size_, from);
+}
+
+template <typename T, size_t ChunkSize>
+void SegmentedVector<T, ChunkSize>::Reserve(size_t capacity) {
+    if (capacity <= Capacity()) {
+        return;
+    }
+    const size_t chunk_count = (capacity + ChunkSize - 1) / ChunkSize;
+    chunks_.Reserve(chunk_count);
+    while (chunks_.Size() < chunk_count) {
+        chunks_.EmplaceBack(ChunkSize);
+    }
+}
+
+template <typename T, size_t ChunkSize>
+void SegmentedVector<T, ChunkSize>::Resize(size_t new_size) {
+    if (new_size < size_) {
+        DestroyFrom(new_size);
+        return;
+    }
+    Reserve(new_size);
+    const size_t old_size = size_;
+    try {
+        while (size_ < new_size) {
+            const size_t chunk_end = std::min(new_size, (size_ / ChunkSize + 1) * ChunkSize);
+            detail::ValueConstructN(Slot(size_), chunk_end - size_);
+            size_ = chunk_end;
+        }
+    } catch (...) {
+        DestroyFrom(old_size);
+        throw;
+    }
+}
+
+template <typename T, size_t ChunkSize>
+void SegmentedVector<T, ChunkSize>::Clear() noexcept {
+    DestroyFrom(0);
+}
+
+template <typename T, size_t ChunkSize>
+void SegmentedVector<T, ChunkSize>::ShrinkToFit() noexcept {
+    const size_t used_chunks = (size_ + ChunkSize - 1) / ChunkSize;
+    while (chunks_.Size() > used_chunks) {
+        chunks_.PopBack();
+    }
+}
+
+template <typename T, size_t ChunkSize>
+void SegmentedVector<T, ChunkSize>::PushBack(const T& value) {
+    EmplaceBack(value);
+}
+
+template <typename T, size_t ChunkSize>
+void SegmentedVector<T, ChunkSize>::PushBack(T&& value) {
+    EmplaceBack(std::move(value));
+}
+
+template <typename T, size_t ChunkSize>
+void SegmentedVector<T, ChunkSize>::PopBack() noexcept {
+    VECTOR_CHECK(size_ != 0);
+    --size_;
+    std::destroy_at(Slot(size_));
+}
+
+// Новый блок выделяется до создания элемента, поэтому аргументы могут ссылаться на элементы вектора:
+// существующие элементы при этом не двигаются
+template <typename T, size_t ChunkSize>
+template <typename... Args>
+T& SegmentedVector<T, ChunkSize>::EmplaceBack(Args&&... args) {
+    if (size_ == Capacity()) {
+        chunks_.EmplaceBack(ChunkSize);
+    }
+    T* element = new (Slot(size_)) T(std::forward<Args>(args)...);
+    ++size_;
+    return *element;
+}
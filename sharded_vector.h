@@ -0,0 +1,158 @@
+#pragma once
+#include "vector.h"
+#include "parallel.h"
+
+#include <algorithm>
+#include <cstddef>
+#include <memory>
+#include <thread>
+#include <type_traits>
+#include <utility>
+
+// Набор векторов-шардов для сбора результатов из нескольких потоков: каждый поток пишет в свой
+// шард без синхронизации, а затем Merge или Flatten склеивают шарды в один Vector. Шарды выровнены
+// по строке кэша, чтобы заголовки соседних векторов не делили одну строку. Склейка считает смещения
+// шардов префиксной суммой, выделяет итоговый буфер один раз и заполняет его кусками в нескольких
+// потоках; тривиально копируемые элементы переносятся memcpy
+template <typename T>
+class ShardedVector {
+public:
+    // По шарду на аппаратный поток
+    ShardedVector();
+    explicit ShardedVector(size_t shard_count);
+
+    size_t ShardCount() const noexcept {
+        return shards_.Size();
+    }
+
+    Vector<T>& Shard(size_t index) noexcept {
+        return shards_[index].values;
+    }
+
+    const Vector<T>& Shard(size_t index) const noexcept {
+        return shards_[index].values;
+    }
+
+    // Суммарное число элементов во всех шардах
+    size_t Size() const noexcept;
+
+    // Очищает шарды, сохраняя их ёмкость
+    void Clear() noexcept;
+
+    // Переносит элементы всех шардов по порядку в новый вектор; шарды очищаются, но сохраняют ёмкость
+    // для следующего раунда. Если перенос бросит исключение, шарды не меняются
+    Vector<T> Merge(const ParallelPolicy& policy = kParallel);
+
+    // То же, но элементы копируются, а шарды остаются нетронутыми
+    Vector<T> Flatten(const ParallelPolicy& policy = kParallel) const;
+
+private:
+    struct alignas(kCacheLineSize) PaddedShard {
+        Vector<T> values;
+    };
+
+    Vector<PaddedShard> shards_;
+
+    // Строит в новом буфере элементы шардов подряд. piece(shard, first, count, dest) создаёт в dest
+    // count элементов шарда shard начиная с first и при исключении не оставляет созданных объектов
+    template <typename Piece>
+    Vector<T> Concatenate(const ParallelPolicy& policy, Piece piece) const;
+
+    // Копирует count элементов source начиная с first в неинициализированную память dest
+    static void CopyPiece(const Vector<T>& source, size_t first, size_t count, T* dest);
+};
+
+
+template <typename T>
+ShardedVector<T>::ShardedVector()
+        : ShardedVector(std::max<size_t>(1, std::thread::hardware_concurrency())) {
+}
+
+template <typename T>
+ShardedVector<T>::ShardedVector(size_t shard_count)
+        : shards_(shard_count) {
+}
+
+template <typename T>
+size_t ShardedVector<T>::Size() const noexcept {
+    size_t size = 0;
+    for (const PaddedShard& shard : shards_) {
+        size += shard.values.Size();
+    }
+    return size;
+}
+
+template <typename T>
+void ShardedVector<T>::Clear() noexcept {
+    for (PaddedShard& shard : shards_) {
+        shard.values.Clear();
+    }
+}
+
+template <typename T>
+void ShardedVector<T>::CopyPiece(const Vector<T>& source, size_t first, size_t count, T* dest) {
+    detail::CopyConstructN(source.Data() + first, count, dest);
+}
+
+template <typename T>
+Vector<T> ShardedVector<T>::Merge(const ParallelPolicy& policy) {
+    Vector<T> merged = Concatenate(policy, [this](size_t shard, size_t first, size_t count, T* dest) {
+        Vector<T>& source = shards_[shard].values;
+        // Бросающий перенос испортил бы шарды при ошибке, поэтому такие T копируются
+        if constexpr (std::is_trivially_copyable_v<T>
+                      || (!std::is_nothrow_move_constructible_v<T> && std::is_copy_constructible_v<T>)) {
+            CopyPiece(source, first, count, dest);
+        } else {
+            detail::MoveConstructN(source.Data() + first, count, dest);
+        }
+    });
+    Clear();
+    return merged;
+}
+
+template <typename T>
+Vector<T> ShardedVector<T>::Flatten(const ParallelPolicy& policy) const {
+    return Concatenate(policy, [this](size_t shard, size_t first, size_t count, T* dest) {
+        CopyPiece(shards_[shard].values, first, count, dest);
+    });
+}
+
+// Куски делятся по числу элементов, а не шардов, поэтому один большой шард тоже склеивается
+// в несколько потоков; кусок может захватывать части нескольких соседних шардов
+template <typename T>
+template <typename Piece>
+Vector<T> ShardedVector<T>::Concatenate(const ParallelPolicy& policy, Piece piece) const {
+    const size_t shard_count = shards_.Size();
+    Vector<size_t> offsets(shard_count + 1, kDefaultInit);
+    offsets[0] = 0;
+    for (size_t shard = 0; shard < shard_count; ++shard) {
+        offsets[shard + 1] = offsets[shard] + shards_[shard].values.Size();
+    }
+    const size_t total = offsets[shard_count];
+
+    RawMemory<T> buffer(total);
+    T* dest = buffer.GetAddress();
+    const auto build = [&offsets, &piece, dest](size_t offset, size_t count) {
+        size_t shard = std::upper_bound(offsets.begin(), offsets.end(), offset) - offsets.begin() - 1;
+        size_t done = 0;
+        try {
+            while (done < count) {
+                const size_t position = offset + done;
+                while (offsets[shard + 1] <= position) {
+                    ++shard;
+                }
+                const size_t length = std::min(count - done, offsets[shard + 1] - position);
+                piece(shard, position - offsets[shard], length, dest + position);
+                done += length;
+            }
+        } catch (...) {
+            detail::DestroyN(dest + offset, done);
+            throw;
+        }
+    };
+    detail::ParallelConstruct(dest, total, policy, build);
+
+    Vector<T> result;
+    result.AdoptBuffer(std::move(buffer), total);
+    return result;
+}
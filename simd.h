@@ -0,0 +1,281 @@
+#pragma once
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <type_traits>
+#include <utility>
+
+// Групповые операции над массивами арифметических типов.
+// Циклы разбиты на блоки по kLanes<T> элементов (один регистр AVX-512) с отдельным аккумулятором
+// на каждую позицию блока: такую форму компилятор векторизует сам, без -ffast-math и без
+// зависимости от порядка суммирования. На x86 с GCC или Clang каждое ядро собрано ещё и
+// под AVX2 и AVX-512, и нужная версия выбирается при первом вызове по возможностям процессора.
+// На AArch64 NEON входит в базовый набор, поэтому простой версии там достаточно.
+// Суммы чисел с плавающей точкой из-за блочного порядка могут отличаться от последовательных
+// в последних битах; результат MinMax при NaN в данных не определён
+namespace simd {
+
+// Тип суммы: целые накапливаются в 64 бита того же знака, остальные типы — в самих себе
+template <typename T>
+using SumType = std::conditional_t<std::is_integral_v<T>,
+                                   std::conditional_t<std::is_signed_v<T>, int64_t, uint64_t>,
+                                   T>;
+
+namespace detail {
+
+#if (defined(__GNUC__) || defined(__clang__)) && (defined(__x86_64__) || defined(__i386__))
+#define VECTOR_SIMD_X86_DISPATCH 1
+#define VECTOR_SIMD_KERNEL static inline __attribute__((always_inline))
+#else
+#define VECTOR_SIMD_KERNEL static inline
+#endif
+
+    template <typename T>
+    constexpr size_t kLanes = sizeof(T) < 64 ? 64 / sizeof(T) : 1;
+
+    struct FillKernel {
+        template <typename T>
+        VECTOR_SIMD_KERNEL void Run(T* data, size_t n, T value) {
+            for (size_t i = 0; i < n; ++i) {
+                data[i] = value;
+            }
+        }
+    };
+
+    struct FindKernel {
+        template <typename T>
+        VECTOR_SIMD_KERNEL size_t Run(const T* data, size_t n, T value) {
+            constexpr size_t kBlock = kLanes<T>;
+            size_t i = 0;
+            for (; i + kBlock <= n; i += kBlock) {
+                unsigned found = 0;
+                for (size_t j = 0; j < kBlock; ++j) {
+                    found |= data[i + j] == value;
+                }
+                if (found != 0) {
+                    break;
+                }
+            }
+            for (; i < n; ++i) {
+                if (data[i] == value) {
+                    return i;
+                }
+            }
+            return n;
+        }
+    };
+
+    struct CountKernel {
+        template <typename T>
+        VECTOR_SIMD_KERNEL size_t Run(const T* data, size_t n, T value) {
+            constexpr size_t kBlock = kLanes<T>;
+            size_t counts[kBlock] = {};
+            size_t i = 0;
+            for (; i + kBlock <= n; i += kBlock) {
+                for (size_t j = 0; j < kBlock; ++j) {
+                    counts[j] += data[i + j] == value;
+                }
+            }
+            size_t count = 0;
+            for (size_t j = 0; j < kBlock; ++j) {
+                count += counts[j];
+            }
+            for (; i < n; ++i) {
+                count += data[i] == value;
+            }
+            return count;
+        }
+    };
+
+    struct SumKernel {
+        template <typename T>
+        VECTOR_SIMD_KERNEL SumType<T> Run(const T* data, size_t n) {
+            constexpr size_t kBlock = kLanes<T>;
+            SumType<T> sums[kBlock] = {};
+            size_t i = 0;
+            for (; i + kBlock <= n; i += kBlock) {
+                for (size_t j = 0; j < kBlock; ++j) {
+                    sums[j] += data[i + j];
+                }
+            }
+            SumType<T> sum = 0;
+            for (size_t j = 0; j < kBlock; ++j) {
+                sum += sums[j];
+            }
+            for (; i < n; ++i) {
+                sum += data[i];
+            }
+            return sum;
+        }
+    };
+
+    struct MinMaxKernel {
+        template <typename T>
+        VECTOR_SIMD_KERNEL std::pair<T, T> Run(const T* data, size_t n) {
+            constexpr size_t kBlock = kLanes<T>;
+            T mins[kBlock];
+            T maxs[kBlock];
+            for (size_t j = 0; j < kBlock; ++j) {
+                mins[j] = data[0];
+                maxs[j] = data[0];
+            }
+            size_t i = 0;
+            for (; i + kBlock <= n; i += kBlock) {
+                for (size_t j = 0; j < kBlock; ++j) {
+                    mins[j] = data[i + j] < mins[j] ? data[i + j] : mins[j];
+                    maxs[j] = maxs[j] < data[i + j] ? data[i + j] : maxs[j];
+                }
+            }
+            for (; i < n; ++i) {
+                mins[0] = data[i] < mins[0] ? data[i] : mins[0];
+                maxs[0] = maxs[0] < data[i] ? data[i] : maxs[0];
+            }
+            std::pair<T, T> result(mins[0], maxs[0]);
+            for (size_t j = 1; j < kBlock; ++j) {
+                result.first = mins[j] < result.first ? mins[j] : result.first;
+                result.second = result.second < maxs[j] ? maxs[j] : result.second;
+            }
+            return result;
+        }
+    };
+
+    struct EqualKernel {
+        template <typename T>
+        VECTOR_SIMD_KERNEL bool Run(const T* lhs, const T* rhs, size_t n) {
+            constexpr size_t kBlock = kLanes<T>;
+            size_t i = 0;
+            for (; i + kBlock <= n; i += kBlock) {
+                unsigned differ = 0;
+                for (size_t j = 0; j < kBlock; ++j) {
+                    differ |= lhs[i + j] != rhs[i + j];
+                }
+                if (differ != 0) {
+                    return false;
+                }
+            }
+            for (; i < n; ++i) {
+                if (lhs[i] != rhs[i]) {
+                    return false;
+                }
+            }
+            return true;
+        }
+    };
+
+    struct TransformKernel {
+        template <typename T, typename UnaryOp>
+        VECTOR_SIMD_KERNEL void Run(T* data, size_t n, UnaryOp& op) {
+            for (size_t i = 0; i < n; ++i) {
+                data[i] = op(data[i]);
+            }
+        }
+    };
+
+#undef VECTOR_SIMD_KERNEL
+
+#if defined(VECTOR_SIMD_X86_DISPATCH)
+    enum class Isa {
+        kBaseline,
+        kAvx2,
+        kAvx512,
+    };
+
+    inline Isa DetectIsa() noexcept {
+        static const Isa isa = [] {
+            __builtin_cpu_init();
+            if (__builtin_cpu_supports("avx512f") && __builtin_cpu_supports("avx512bw")) {
+                return Isa::kAvx512;
+            }
+            if (__builtin_cpu_supports("avx2")) {
+                return Isa::kAvx2;
+            }
+            return Isa::kBaseline;
+        }();
+        return isa;
+    }
+
+    template <typename Kernel, typename... Args>
+    __attribute__((target("avx2"))) decltype(auto) RunAvx2(Args&&... args) {
+        return Kernel::Run(std::forward<Args>(args)...);
+    }
+
+    template <typename Kernel, typename... Args>
+    __attribute__((target("avx512f,avx512bw"))) decltype(auto) RunAvx512(Args&&... args) {
+        return Kernel::Run(std::forward<Args>(args)...);
+    }
+#endif
+
+    template <typename Kernel, typename... Args>
+    decltype(auto) Run(Args&&... args) {
+#if defined(VECTOR_SIMD_X86_DISPATCH)
+        switch (DetectIsa()) {
+            case Isa::kAvx512:
+                return RunAvx512<Kernel>(std::forward<Args>(args)...);
+            case Isa::kAvx2:
+                return RunAvx2<Kernel>(std::forward<Args>(args)...);
+            case Isa::kBaseline:
+                break;
+        }
+#endif
+        return Kernel::Run(std::forward<Args>(args)...);
+    }
+
+}  // namespace detail
+
+// Типы, для которых есть ядра
+template <typename T>
+constexpr bool kSupported = std::is_arithmetic_v<T> && !std::is_same_v<T, bool>;
+
+template <typename T>
+void Fill(T* data, size_t n, T value) noexcept {
+    static_assert(kSupported<T>);
+    detail::Run<detail::FillKernel>(data, n, value);
+}
+
+// Индекс первого элемента, равного value, или n
+template <typename T>
+size_t Find(const T* data, size_t n, T value) noexcept {
+    static_assert(kSupported<T>);
+    return detail::Run<detail::FindKernel>(data, n, value);
+}
+
+template <typename T>
+size_t Count(const T* data, size_t n, T value) noexcept {
+    static_assert(kSupported<T>);
+    return detail::Run<detail::CountKernel>(data, n, value);
+}
+
+template <typename T>
+SumType<T> Sum(const T* data, size_t n) noexcept {
+    static_assert(kSupported<T>);
+    return detail::Run<detail::SumKernel>(data, n);
+}
+
+// Наименьший и наибольший элементы; массив не должен быть пустым
+template <typename T>
+std::pair<T, T> MinMax(const T* data, size_t n) noexcept {
+    static_assert(kSupported<T>);
+    assert(n != 0);
+    return detail::Run<detail::MinMaxKernel>(data, n);
+}
+
+template <typename T>
+bool Equal(const T* lhs, const T* rhs, size_t n) noexcept {
+    static_assert(kSupported<T>);
+    if constexpr (std::has_unique_object_representations_v<T>) {
+        // Для целых равенство значений совпадает с побайтовым, а memcmp уже векторизован библиотекой
+        return n == 0 || std::memcmp(lhs, rhs, n * sizeof(T)) == 0;
+    } else {
+        return detail::Run<detail::EqualKernel>(lhs, rhs, n);
+    }
+}
+
+// Заменяет каждый элемент на op(элемент); op должен быть доступен для встраивания, чтобы цикл векторизовался
+template <typename T, typename UnaryOp>
+void Transform(T* data, size_t n, UnaryOp op) {
+    static_assert(kSupported<T>);
+    detail::Run<detail::TransformKernel>(data, n, op);
+}
+
+}  // namespace simd
@@ -0,0 +1,268 @@
+#pragma once
+#include "vector.h"
+#include "vector_check.h"
+
+// Вектор, хранящий до N элементов внутри себя и переходящий на память RawMemory в куче
+// только при переполнении. Обратно во встроенный буфер элементы не возвращаются
+template <typename T, size_t N, typename Growth = DoublingGrowth>
+class SmallVector {
+    static_assert(N > 0, "inline capacity must be positive");
+
+public:
+    SmallVector() = default;
+    explicit SmallVector(size_t size);
+    SmallVector(const SmallVector& other);
+    SmallVector(SmallVector&& other) noexcept(std::is_nothrow_move_constructible_v<T>);
+    ~SmallVector();
+
+    using iterator = T*;
+    using const_iterator = const T*;
+
+    SmallVector& operator=(const SmallVector& other);
+    SmallVector& operator=(SmallVector&& other) noexcept(std::is_nothrow_move_constructible_v<T>);
+
+    void Swap(SmallVector& other) noexcept(std::is_nothrow_move_constructible_v<T>);
+
+    void Reserve(size_t capacity);
+
+    void Resize(size_t new_size);
+    void PushBack(const T& value);
+    void PushBack(T&& value);
+    void PopBack() noexcept;
+
+    template<typename... Args>
+    T& EmplaceBack(Args&&... args);
+
+    size_t Size() const noexcept {
+        return size_;
+    }
+
+    size_t Capacity() const noexcept {
+        return IsInline() ? N : heap_.Capacity();
+    }
+
+    // Элементы лежат во встроенном буфере
+    bool IsInline() const noexcept {
+        return heap_.GetAddress() == nullptr;
+    }
+
+    const T& operator[](size_t index) const noexcept {
+        return const_cast<SmallVector&>(*this)[index];
+    }
+
+    T& operator[](size_t index) noexcept {
+        VECTOR_CHECK(index < size_);
+        return Data()[index];
+    }
+
+    iterator begin() noexcept {
+        return Data();
+    }
+    iterator end() noexcept {
+        return Data() + size_;
+    }
+    const_iterator begin() const noexcept {
+        return cbegin();
+    }
+    const_iterator end() const noexcept {
+        return cend();
+    }
+    const_iterator cbegin() const noexcept {
+        return const_cast<SmallVector&>(*this).Data();
+    }
+    const_iterator cend() const noexcept {
+        return cbegin() + size_;
+    }
+
+    template<typename... Args>
+    iterator Emplace(const_iterator pos, Args&&... args);
+    iterator Erase(const_iterator pos);
+    iterator Insert(const_iterator pos, const T& value);
+    iterator Insert(const_iterator pos, T&& value);
+
+private:
+    RawMemory<T> heap_;
+    size_t size_ = 0;
+    alignas(T) unsigned char inline_buffer_[N * sizeof(T)];
+
+    T* Data() noexcept {
+        return IsInline() ? reinterpret_cast<T*>(inline_buffer_) : heap_.GetAddress();
+    }
+
+    // Забирает элементы other, оставляя его пустым; собственных элементов быть не должно
+    void TakeFrom(SmallVector& other) noexcept(std::is_nothrow_move_constructible_v<T>);
+
+    template<typename... Args>
+    iterator EmplaceWithReallocation(size_t pos_index, Args&&... args);
+};
+
+
+template<typename T, size_t N, typename Growth>
+SmallVector<T, N, Growth>::SmallVector(size_t size) {
+    Reserve(size);
+    detail::ValueConstructN(Data(), size);
+    size_ = size;
+}
+
+template<typename T, size_t N, typename Growth>
+SmallVector<T, N, Growth>::SmallVector(const SmallVector& other) {
+    Reserve(other.size_);
+    detail::CopyConstructN(other.begin(), other.size_, Data());
+    size_ = other.size_;
+}
+
+template<typename T, size_t N, typename Growth>
+SmallVector<T, N, Growth>::SmallVector(SmallVector&& other) noexcept(std::is_nothrow_move_constructible_v<T>) {
+    TakeFrom(other);
+}
+
+template<typename T, size_t N, typename Growth>
+SmallVector<T, N, Growth>::~SmallVector() {
+    detail::DestroyN(Data(), size_);
+}
+
+template<typename T, size_t N, typename Growth>
+void SmallVector<T, N, Growth>::TakeFrom(SmallVector& other) noexcept(std::is_nothrow_move_constructible_v<T>) {
+    if (other.IsInline()) {
+        detail::RelocateN(other.Data(), other.size_, Data());
+    } else {
+        heap_ = std::move(other.heap_);
+    }
+    size_ = std::exchange(other.size_, 0);
+}
+
+template<typename T, size_t N, typename Growth>
+SmallVector<T, N, Growth>& SmallVector<T, N, Growth>::operator=(const SmallVector& other) {
+    if (&other != this) {
+        SmallVector other_copy(other);
+        Swap(other_copy);
+    }
+    return *this;
+}
+
+template<typename T, size_t N, typename Growth>
+SmallVector<T, N, Growth>& SmallVector<T, N, Growth>::operator=(SmallVector&& other)
+        noexcept(std::is_nothrow_move_constructible_v<T>) {
+    if (&other != this) {
+        detail::DestroyN(Data(), size_);
+        size_ = 0;
+        RawMemory<T>().Swap(heap_);
+        TakeFrom(other);
+    }
+    return *this;
+}
+
+template<typename T, size_t N, typename Growth>
+void SmallVector<T, N, Growth>::Swap(SmallVector& other) noexcept(std::is_nothrow_move_constructible_v<T>) {
+    if (!IsInline() && !other.IsInline()) {
+        heap_.Swap(other.heap_);
+        std::swap(size_, other.size_);
+        return;
+    }
+    SmallVector tmp(std::move(other));
+    other = std::move(*this);
+    *this = std::move(tmp);
+}
+
+template<typename T, size_t N, typename Growth>
+void SmallVector<T, N, Growth>::Reserve(size_t capacity) {
+    if (capacity <= Capacity()) {
+        return;
+    }
+
+    RawMemory<T> new_buffer(capacity);
+    detail::RelocateN(Data(), size_, new_buffer.GetAddress());
+    heap_.Swap(new_buffer);
+}
+
+template<typename T, size_t N, typename Growth>
+void SmallVector<T, N, Growth>::Resize(size_t new_size) {
+    if (new_size < size_) {
+        detail::DestroyN(Data() + new_size, size_ - new_size);
+    } else if (new_size > size_) {
+        Reserve(new_size);
+        detail::ValueConstructN(Data() + size_, new_size - size_);
+    }
+    size_ = new_size;
+}
+
+template<typename T, size_t N, typename Growth>
+void SmallVector<T, N, Growth>::PushBack(const T& value) {
+    EmplaceBack(value);
+}
+
+template<typename T, size_t N, typename Growth>
+void SmallVector<T, N, Growth>::PushBack(T&& value) {
+    EmplaceBack(std::move(value));
+}
+
+template<typename T, size_t N, typename Growth>
+void SmallVector<T, N, Growth>::PopBack() noexcept {
+    VECTOR_CHECK(size_ != 0);
+    Data()[--size_].~T();
+}
+
+template<typename T, size_t N, typename Growth>
+template<typename... Args>
+T& SmallVector<T, N, Growth>::EmplaceBack(Args&&... args) {
+    if (size_ == Capacity()) {
+        return *EmplaceWithReallocation(size_, std::forward<Args>(args)...);
+    }
+    T* element = new (Data() + size_) T (std::forward<Args>(args)...);
+    ++size_;
+    return *element;
+}
+
+template<typename T, size_t N, typename Growth>
+template<typename... Args>
+typename SmallVector<T, N, Growth>::iterator SmallVector<T, N, Growth>::Emplace(const_iterator pos, Args&&... args) {
+    VECTOR_CHECK(detail::PointerInRange(pos, cbegin(), cend()));
+
+    const size_t pos_index = pos - cbegin();
+    if (size_ == Capacity()) {
+        return EmplaceWithReallocation(pos_index, std::forward<Args>(args)...);
+    }
+
+    iterator result = detail::EmplaceInPlace(Data(), size_, pos_index, std::forward<Args>(args)...);
+    ++size_;
+    return result;
+}
+
+template<typename T, size_t N, typename Growth>
+template<typename... Args>
+typename SmallVector<T, N, Growth>::iterator SmallVector<T, N, Growth>::EmplaceWithReallocation(size_t pos_index,
+                                                                                               Args&&... args) {
+    RawMemory<T> new_buffer(Growth::NextCapacity(Capacity(), size_ + 1, sizeof(T)));
+    iterator new_pos = new_buffer + pos_index;
+    new (new_pos) T (std::forward<Args>(args)...);
+
+    try {
+        detail::RelocateWithGap(Data(), size_, pos_index, new_buffer.GetAddress());
+    } catch (...) {
+        new_pos->~T();
+        throw;
+    }
+    heap_.Swap(new_buffer);
+
+    ++size_;
+    return new_pos;
+}
+
+template<typename T, size_t N, typename Growth>
+typename SmallVector<T, N, Growth>::iterator SmallVector<T, N, Growth>::Insert(const_iterator pos, const T& value) {
+    return Emplace(pos, value);
+}
+
+template<typename T, size_t N, typename Growth>
+typename SmallVector<T, N, Growth>::iterator SmallVector<T, N, Growth>::Insert(const_iterator pos, T&& value) {
+    return Emplace(pos, std::move(value));
+}
+
+template<typename T, size_t N, typename Growth>
+typename SmallVector<T, N, Growth>::iterator SmallVector<T, N, Growth>::Erase(const_iterator pos) {
+    VECTOR_CHECK(detail::PointerInRange(pos, cbegin(), cend()) && pos != cend());
+
+    iterator result = detail::EraseAt(Data(), size_, pos - cbegin());
+    --size_;
+    return result;
+}
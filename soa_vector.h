@@ -0,0 +1,472 @@
+#pragma once
+#include "vector.h"
+#include "vector_check.h"
+#include "index_iterator.h"
+
+#include <cstddef>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+
+// Непрерывный участок одного столбца SoAVector
+template <typename T>
+class ColumnSpan {
+public:
+    ColumnSpan(T* data, size_t size) noexcept
+            : data_(data), size_(size) {
+    }
+
+    T* Data() const noexcept {
+        return data_;
+    }
+
+    size_t Size() const noexcept {
+        return size_;
+    }
+
+    T& operator[](size_t index) const noexcept {
+        VECTOR_CHECK(index < size_);
+        return data_[index];
+    }
+
+    T* begin() const noexcept {
+        return data_;
+    }
+
+    T* end() const noexcept {
+        return data_ + size_;
+    }
+
+private:
+    T* data_;
+    size_t size_;
+};
+
+// Вектор записей из полей Ts..., хранящий каждое поле в отдельном буфере RawMemory (структура массивов).
+// Обращение к элементу возвращает кортеж ссылок на его поля: auto [id, price] = v[i];
+// Column<I>() отдаёт столбец целиком для последовательных и SIMD-проходов.
+// Все столбцы имеют общую ёмкость и растут вместе по политике Growth,
+// размер элемента для неё — сумма размеров полей
+template <typename Growth, typename... Ts>
+class BasicSoAVector {
+    static_assert(sizeof...(Ts) > 0, "SoAVector needs at least one field");
+
+public:
+    using Reference = std::tuple<Ts&...>;
+    using ConstReference = std::tuple<const Ts&...>;
+    using iterator = IndexIterator<BasicSoAVector, std::tuple<Ts...>>;
+    using const_iterator = IndexIterator<const BasicSoAVector, std::tuple<Ts...>>;
+
+    template <size_t I>
+    using ColumnType = std::tuple_element_t<I, std::tuple<Ts...>>;
+
+    BasicSoAVector() = default;
+    explicit BasicSoAVector(size_t size);
+    BasicSoAVector(const BasicSoAVector& other);
+    BasicSoAVector(BasicSoAVector&& other) noexcept;
+    ~BasicSoAVector();
+
+    BasicSoAVector& operator=(const BasicSoAVector& other);
+    BasicSoAVector& operator=(BasicSoAVector&& other) noexcept;
+
+    void Swap(BasicSoAVector& other) noexcept;
+
+    void Reserve(size_t capacity);
+    void Resize(size_t new_size);
+    void Clear() noexcept;
+
+    void PushBack(const Ts&... values);
+    void PushBack(Ts&&... values);
+    void PopBack() noexcept;
+
+    // Принимает по одному аргументу на каждое поле
+    template <typename... Args>
+    Reference EmplaceBack(Args&&... args);
+
+    size_t Size() const noexcept {
+        return size_;
+    }
+
+    size_t Capacity() const noexcept {
+        return std::get<0>(columns_).Capacity();
+    }
+
+    Reference operator[](size_t index) noexcept {
+        VECTOR_CHECK(index < size_);
+        return ElementAt<Reference>(*this, index, std::index_sequence_for<Ts...>{});
+    }
+
+    ConstReference operator[](size_t index) const noexcept {
+        VECTOR_CHECK(index < size_);
+        return ElementAt<ConstReference>(*this, index, std::index_sequence_for<Ts...>{});
+    }
+
+    template <size_t I>
+    ColumnSpan<ColumnType<I>> Column() noexcept {
+        return {std::get<I>(columns_).GetAddress(), size_};
+    }
+
+    template <size_t I>
+    ColumnSpan<const ColumnType<I>> Column() const noexcept {
+        return {std::get<I>(columns_).GetAddress(), size_};
+    }
+
+    iterator begin() noexcept {
+        return {this, 0};
+    }
+    iterator end() noexcept {
+        return {this, size_};
+    }
+    const_iterator begin() const noexcept {
+        return cbegin();
+    }
+    const_iterator end() const noexcept {
+        return cend();
+    }
+    const_iterator cbegin() const noexcept {
+        return {this, 0};
+    }
+    const_iterator cend() const noexcept {
+        return {this, size_};
+    }
+
+    template <typename... Args>
+    iterator Emplace(const_iterator pos, Args&&... args);
+    iterator Insert(const_iterator pos, const Ts&... values);
+    iterator Insert(const_iterator pos, Ts&&... values);
+    iterator Erase(const_iterator pos);
+    iterator Erase(const_iterator first, const_iterator last);
+
+private:
+    static constexpr size_t kElementSize = (sizeof(Ts) + ...);
+
+    // Столбцы, перенос которых при росте может выбросить исключение: они копируются
+    template <typename T>
+    static constexpr bool kRelocatesNothrow = IsTriviallyRelocatableV<T> || std::is_nothrow_move_constructible_v<T>
+                                              || !std::is_copy_constructible_v<T>;
+
+    // Столбцы, из которых элемент удаляется без исключений: на этом держится откат вставки
+    template <typename T>
+    static constexpr bool kErasesNothrow = IsTriviallyRelocatableV<T> || std::is_nothrow_move_assignable_v<T>;
+
+    std::tuple<RawMemory<Ts>...> columns_;
+    size_t size_ = 0;
+
+    template <size_t I>
+    ColumnType<I>* Data() noexcept {
+        return std::get<I>(columns_).GetAddress();
+    }
+
+    template <typename Result, typename Self, size_t... Is>
+    static Result ElementAt(Self& self, size_t index, std::index_sequence<Is...>) noexcept {
+        return Result(std::get<Is>(self.columns_)[index]...);
+    }
+
+    // Вызывает fn(std::integral_constant<size_t, I>) для каждого столбца по порядку
+    template <typename Fn>
+    static void ForEachColumn(Fn&& fn) {
+        ForEachColumnImpl(fn, std::index_sequence_for<Ts...>{});
+    }
+
+    template <typename Fn, size_t... Is>
+    static void ForEachColumnImpl(Fn& fn, std::index_sequence<Is...>) {
+        (fn(std::integral_constant<size_t, Is>{}), ...);
+    }
+
+    // Выполняет fn(std::integral_constant<size_t, I>) для столбцов по порядку; если столбец выбросит
+    // исключение, для уже обработанных столбцов вызывается undo
+    template <typename Fn, typename Undo>
+    static void ForEachColumnOrUndo(Fn&& fn, Undo&& undo);
+
+    template <typename Tuple>
+    void ConstructBack(Tuple&& args);
+    template <typename Tuple>
+    void EmplaceAt(size_t pos_index, Tuple&& args);
+    // Хотя бы один из аргументов лежит внутри какого-нибудь столбца
+    template <typename... Args>
+    bool AnyArgumentInColumns(const Args&... args) const noexcept;
+    void Reallocate(size_t new_capacity);
+};
+
+template <typename... Ts>
+using SoAVector = BasicSoAVector<DoublingGrowth, Ts...>;
+
+
+template <typename Growth, typename... Ts>
+template <typename Fn, typename Undo>
+void BasicSoAVector<Growth, Ts...>::ForEachColumnOrUndo(Fn&& fn, Undo&& undo) {
+    size_t done = 0;
+    try {
+        ForEachColumn([&](auto column) {
+            fn(column);
+            ++done;
+        });
+    } catch (...) {
+        ForEachColumn([&](auto column) {
+            if (decltype(column)::value < done) {
+                undo(column);
+            }
+        });
+        throw;
+    }
+}
+
+template <typename Growth, typename... Ts>
+BasicSoAVector<Growth, Ts...>::BasicSoAVector(size_t size) {
+    Resize(size);
+}
+
+template <typename Growth, typename... Ts>
+BasicSoAVector<Growth, Ts...>::BasicSoAVector(const BasicSoAVector& other) {
+    Reserve(other.size_);
+    ForEachColumnOrUndo(
+            [&](auto column) {
+                constexpr size_t I = decltype(column)::value;
+                detail::CopyConstructN(std::get<I>(other.columns_).GetAddress(), other.size_, Data<I>());
+            },
+            [&](auto column) {
+                detail::DestroyN(Data<decltype(column)::value>(), other.size_);
+            });
+    size_ = other.size_;
+}
+
+template <typename Growth, typename... Ts>
+BasicSoAVector<Growth, Ts...>::BasicSoAVector(BasicSoAVector&& other) noexcept
+        : columns_(std::move(other.columns_)), size_(std::exchange(other.size_, 0)) {
+}
+
+template <typename Growth, typename... Ts>
+BasicSoAVector<Growth, Ts...>::~BasicSoAVector() {
+    Clear();
+}
+
+template <typename Growth, typename... Ts>
+BasicSoAVector<Growth, Ts...>& BasicSoAVector<Growth, Ts...>::operator=(const BasicSoAVector& other) {
+    if (&other != this) {
+        BasicSoAVector other_copy(other);
+        Swap(other_copy);
+    }
+    return *this;
+}
+
+template <typename Growth, typename... Ts>
+BasicSoAVector<Growth, Ts...>& BasicSoAVector<Growth, Ts...>::operator=(BasicSoAVector&& other) noexcept {
+    if (&other != this) {
+        Clear();
+        ForEachColumn([&](auto column) {
+            constexpr size_t I = decltype(column)::value;
+            std::get<I>(columns_) = std::move(std::get<I>(other.columns_));
+        });
+        size_ = std::exchange(other.size_, 0);
+    }
+    return *this;
+}
+
+template <typename Growth, typename... Ts>
+void BasicSoAVector<Growth, Ts...>::Swap(BasicSoAVector& other) noexcept {
+    ForEachColumn([&](auto column) {
+        constexpr size_t I = decltype(column)::value;
+        std::get<I>(columns_).Swap(std::get<I>(other.columns_));
+    });
+    std::swap(size_, other.size_);
+}
+
+template <typename Growth, typename... Ts>
+void BasicSoAVector<Growth, Ts...>::Reserve(size_t capacity) {
+    if (capacity > Capacity()) {
+        Reallocate(capacity);
+    }
+}
+
+// Сначала копируются столбцы, перенос которых может выбросить исключение; при неудаче старые столбцы
+// не тронуты. Остальные столбцы переносятся уже после, так как это не бросает
+template <typename Growth, typename... Ts>
+void BasicSoAVector<Growth, Ts...>::Reallocate(size_t new_capacity) {
+    std::tuple<RawMemory<Ts>...> new_columns{RawMemory<Ts>(new_capacity)...};
+
+    ForEachColumnOrUndo(
+            [&](auto column) {
+                constexpr size_t I = decltype(column)::value;
+                if constexpr (!kRelocatesNothrow<ColumnType<I>>) {
+                    detail::CopyConstructN(Data<I>(), size_, std::get<I>(new_columns).GetAddress());
+                }
+            },
+            [&](auto column) {
+                constexpr size_t I = decltype(column)::value;
+                if constexpr (!kRelocatesNothrow<ColumnType<I>>) {
+                    detail::DestroyN(std::get<I>(new_columns).GetAddress(), size_);
+                }
+            });
+
+    ForEachColumn([&](auto column) {
+        constexpr size_t I = decltype(column)::value;
+        if constexpr (kRelocatesNothrow<ColumnType<I>>) {
+            detail::RelocateN(Data<I>(), size_, std::get<I>(new_columns).GetAddress());
+        } else {
+            detail::DestroyN(Data<I>(), size_);
+        }
+        std::get<I>(columns_).Swap(std::get<I>(new_columns));
+    });
+}
+
+template <typename Growth, typename... Ts>
+void BasicSoAVector<Growth, Ts...>::Resize(size_t new_size) {
+    if (new_size < size_) {
+        ForEachColumn([&](auto column) {
+            detail::DestroyN(Data<decltype(column)::value>() + new_size, size_ - new_size);
+        });
+    } else if (new_size > size_) {
+        Reserve(new_size);
+        ForEachColumnOrUndo(
+                [&](auto column) {
+                    detail::ValueConstructN(Data<decltype(column)::value>() + size_, new_size - size_);
+                },
+                [&](auto column) {
+                    detail::DestroyN(Data<decltype(column)::value>() + size_, new_size - size_);
+                });
+    }
+    size_ = new_size;
+}
+
+template <typename Growth, typename... Ts>
+void BasicSoAVector<Growth, Ts...>::Clear() noexcept {
+    ForEachColumn([&](auto column) {
+        detail::DestroyN(Data<decltype(column)::value>(), size_);
+    });
+    size_ = 0;
+}
+
+template <typename Growth, typename... Ts>
+void BasicSoAVector<Growth, Ts...>::PushBack(const Ts&... values) {
+    EmplaceBack(values...);
+}
+
+template <typename Growth, typename... Ts>
+void BasicSoAVector<Growth, Ts...>::PushBack(Ts&&... values) {
+    EmplaceBack(std::move(values)...);
+}
+
+template <typename Growth, typename... Ts>
+void BasicSoAVector<Growth, Ts...>::PopBack() noexcept {
+    VECTOR_CHECK(size_ != 0);
+    --size_;
+    ForEachColumn([&](auto column) {
+        std::destroy_at(Data<decltype(column)::value>() + size_);
+    });
+}
+
+template <typename Growth, typename... Ts>
+template <typename Tuple>
+void BasicSoAVector<Growth, Ts...>::ConstructBack(Tuple&& args) {
+    ForEachColumnOrUndo(
+            [&](auto column) {
+                constexpr size_t I = decltype(column)::value;
+                new (Data<I>() + size_) ColumnType<I>(std::get<I>(std::forward<Tuple>(args)));
+            },
+            [&](auto column) {
+                std::destroy_at(Data<decltype(column)::value>() + size_);
+            });
+    ++size_;
+}
+
+// При росте аргументы сначала копируются во временный кортеж, так как могут ссылаться на элементы вектора
+template <typename Growth, typename... Ts>
+template <typename... Args>
+typename BasicSoAVector<Growth, Ts...>::Reference BasicSoAVector<Growth, Ts...>::EmplaceBack(Args&&... args) {
+    static_assert(sizeof...(Args) == sizeof...(Ts), "EmplaceBack takes one argument per field");
+    if (size_ == Capacity()) {
+        std::tuple<Ts...> values(std::forward<Args>(args)...);
+        Reallocate(Growth::NextCapacity(Capacity(), size_ + 1, kElementSize));
+        ConstructBack(std::move(values));
+    } else {
+        ConstructBack(std::forward_as_tuple(std::forward<Args>(args)...));
+    }
+    return (*this)[size_ - 1];
+}
+
+template <typename Growth, typename... Ts>
+template <typename... Args>
+bool BasicSoAVector<Growth, Ts...>::AnyArgumentInColumns(const Args&... args) const noexcept {
+    bool found = false;
+    ForEachColumn([&](auto column) {
+        const auto* data = std::get<decltype(column)::value>(columns_).GetAddress();
+        found = found || detail::AnyArgumentWithin(data, data + size_, args...);
+    });
+    return found;
+}
+
+// Столбцы сдвигаются по очереди, поэтому аргументы не должны ссылаться на элементы вектора:
+// об этом заботится Emplace. Если столбец выбросит исключение, из уже сдвинутых вставленный элемент
+// удаляется обратно, и это удаление исключений не бросает
+template <typename Growth, typename... Ts>
+template <typename Tuple>
+void BasicSoAVector<Growth, Ts...>::EmplaceAt(size_t pos_index, Tuple&& args) {
+    ForEachColumnOrUndo(
+            [&](auto column) {
+                constexpr size_t I = decltype(column)::value;
+                detail::EmplaceInPlace(Data<I>(), size_, pos_index, std::get<I>(std::forward<Tuple>(args)));
+            },
+            [&](auto column) noexcept {
+                detail::EraseAt(Data<decltype(column)::value>(), size_ + 1, pos_index);
+            });
+    ++size_;
+}
+
+// Аргументы, ссылающиеся на элементы вектора, сначала копируются во временный кортеж и без роста:
+// иначе поле из ещё не сдвинутого столбца было бы прочитано уже после сдвига
+template <typename Growth, typename... Ts>
+template <typename... Args>
+typename BasicSoAVector<Growth, Ts...>::iterator BasicSoAVector<Growth, Ts...>::Emplace(const_iterator pos,
+                                                                                        Args&&... args) {
+    static_assert(sizeof...(Args) == sizeof...(Ts), "Emplace takes one argument per field");
+    static_assert((kErasesNothrow<Ts> && ...), "Emplace needs fields that are moved on assignment without exceptions");
+    VECTOR_CHECK(pos.Index() <= size_);
+
+    const size_t pos_index = pos.Index();
+    if (size_ == Capacity()) {
+        std::tuple<Ts...> values(std::forward<Args>(args)...);
+        Reallocate(Growth::NextCapacity(Capacity(), size_ + 1, kElementSize));
+        EmplaceAt(pos_index, std::move(values));
+    } else if (AnyArgumentInColumns(args...)) {
+        std::tuple<Ts...> values(std::forward<Args>(args)...);
+        EmplaceAt(pos_index, std::move(values));
+    } else {
+        EmplaceAt(pos_index, std::forward_as_tuple(std::forward<Args>(args)...));
+    }
+    return begin() + pos_index;
+}
+
+template <typename Growth, typename... Ts>
+typename BasicSoAVector<Growth, Ts...>::iterator BasicSoAVector<Growth, Ts...>::Insert(const_iterator pos,
+                                                                                       const Ts&... values) {
+    return Emplace(pos, values...);
+}
+
+template <typename Growth, typename... Ts>
+typename BasicSoAVector<Growth, Ts...>::iterator BasicSoAVector<Growth, Ts...>::Insert(const_iterator pos,
+                                                                                       Ts&&... values) {
+    return Emplace(pos, std::move(values)...);
+}
+
+template <typename Growth, typename... Ts>
+typename BasicSoAVector<Growth, Ts...>::iterator BasicSoAVector<Growth, Ts...>::Erase(const_iterator pos) {
+    VECTOR_CHECK(pos.Index() < size_);
+
+    ForEachColumn([&](auto column) {
+        detail::EraseAt(Data<decltype(column)::value>(), size_, pos.Index());
+    });
+    --size_;
+    return begin() + pos.Index();
+}
+
+template <typename Growth, typename... Ts>
+typename BasicSoAVector<Growth, Ts...>::iterator BasicSoAVector<Growth, Ts...>::Erase(const_iterator first,
+                                                                                      const_iterator last) {
+    VECTOR_CHECK(first.Index() <= last.Index() && last.Index() <= size_);
+
+    ForEachColumn([&](auto column) {
+        detail::EraseRange(Data<decltype(column)::value>(), size_, first.Index(), last.Index());
+    });
+    size_ -= last.Index() - first.Index();
+    return begin() + first.Index();
+}
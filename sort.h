@@ -0,0 +1,261 @@
+#pragma once
+#include "parallel.h"
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <iterator>
+#include <memory>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+// Ядра сортировки для Vector. Всем нужна сырая память scratch под n элементов: вектор отдаёт под неё
+// свободную ёмкость, если её хватает, и только иначе выделяет временный буфер.
+// Параллельная сортировка — не сортировка с перехватом работы (work stealing), а фиксированное деление:
+// threads равных кусков сортируются каждый в своём потоке, затем раунды слияний, где каждое слияние
+// пары делится на части равной длины результата поиском по диагонали (merge path). Так сделано потому,
+// что в библиотеке нет пула потоков с очередями задач: ParallelPolicy создаёт потоки на время вызова, и
+// перехват работы пришлось бы строить с нуля ради одной операции. Цена — простой потоков, если
+// стоимость comp сильно неравномерна: кусок с дорогими сравнениями задерживает весь раунд, а
+// освободившиеся потоки не могут забрать у него работу. Для однородных ключей, ради которых сортировка
+// и нужна, куски и части слияний выходят одинаковыми по времени
+namespace detail {
+
+    // Короче этого std::sort обгоняет поразрядную сортировку
+    inline constexpr size_t kRadixSortThreshold = 256;
+    // Длина кусков, которые сортировка слиянием упорядочивает вставками
+    inline constexpr size_t kInsertionSortRun = 32;
+
+    template <typename T>
+    inline constexpr bool kRadixSortable = (std::is_integral_v<T> || std::is_floating_point_v<T>)
+                                           && !std::is_same_v<T, bool>
+                                           && (sizeof(T) == 1 || sizeof(T) == 2 || sizeof(T) == 4 || sizeof(T) == 8);
+
+    // Сравнение по умолчанию, которое поразрядная сортировка воспроизводит
+    template <typename Compare, typename T>
+    inline constexpr bool kIsDefaultLess = std::is_same_v<Compare, std::less<>> || std::is_same_v<Compare, std::less<T>>;
+
+    template <size_t Size>
+    struct UnsignedOfSize;
+    template <>
+    struct UnsignedOfSize<1> { using Type = uint8_t; };
+    template <>
+    struct UnsignedOfSize<2> { using Type = uint16_t; };
+    template <>
+    struct UnsignedOfSize<4> { using Type = uint32_t; };
+    template <>
+    struct UnsignedOfSize<8> { using Type = uint64_t; };
+
+    // Беззнаковый ключ, порядок которого совпадает с порядком значений: у знаковых целых инвертируется
+    // знаковый бит, у отрицательных чисел с плавающей точкой — все биты
+    template <typename T>
+    typename UnsignedOfSize<sizeof(T)>::Type ToRadixKey(T value) noexcept {
+        using Key = typename UnsignedOfSize<sizeof(T)>::Type;
+        constexpr Key kSignBit = Key{1} << (sizeof(T) * 8 - 1);
+        Key bits;
+        std::memcpy(&bits, &value, sizeof(T));
+        if constexpr (std::is_floating_point_v<T>) {
+            return (bits & kSignBit) != 0 ? static_cast<Key>(~bits) : static_cast<Key>(bits | kSignBit);
+        } else if constexpr (std::is_signed_v<T>) {
+            return static_cast<Key>(bits ^ kSignBit);
+        } else {
+            return bits;
+        }
+    }
+
+    // Поразрядная сортировка LSD по байтам. Гистограммы всех разрядов строятся за один проход,
+    // разряд, одинаковый у всех элементов, пропускается. Сортировка устойчива
+    template <typename T>
+    void RadixSort(T* data, size_t n, T* scratch) noexcept {
+        static_assert(kRadixSortable<T>);
+        constexpr size_t kPasses = sizeof(T);
+        size_t counts[kPasses][256] = {};
+        for (size_t i = 0; i < n; ++i) {
+            const auto key = ToRadixKey(data[i]);
+            for (size_t pass = 0; pass < kPasses; ++pass) {
+                ++counts[pass][(key >> (pass * 8)) & 0xFF];
+            }
+        }
+
+        T* from = data;
+        T* to = scratch;
+        for (size_t pass = 0; pass < kPasses && n != 0; ++pass) {
+            size_t* count = counts[pass];
+            if (count[(ToRadixKey(from[0]) >> (pass * 8)) & 0xFF] == n) {
+                continue;
+            }
+            size_t offset = 0;
+            for (size_t digit = 0; digit < 256; ++digit) {
+                offset += std::exchange(count[digit], offset);
+            }
+            for (size_t i = 0; i < n; ++i) {
+                to[count[(ToRadixKey(from[i]) >> (pass * 8)) & 0xFF]++] = from[i];
+            }
+            std::swap(from, to);
+        }
+        if (from != data) {
+            std::memcpy(static_cast<void*>(data), static_cast<const void*>(from), n * sizeof(T));
+        }
+    }
+
+    // Устойчивая сортировка вставками без выделения памяти
+    template <typename T, typename Compare>
+    void InsertionSort(T* data, size_t n, Compare& comp) {
+        for (size_t i = 1; i < n; ++i) {
+            if (!comp(data[i], data[i - 1])) {
+                continue;
+            }
+            T value = std::move(data[i]);
+            size_t j = i;
+            do {
+                data[j] = std::move(data[j - 1]);
+                --j;
+            } while (j > 0 && comp(value, data[j - 1]));
+            data[j] = std::move(value);
+        }
+    }
+
+    // Сколько элементов из a[0, m) входит в первые d элементов устойчивого слияния a и b[0, k)
+    template <typename T, typename Compare>
+    size_t MergeSplit(const T* a, size_t m, const T* b, size_t k, size_t d, Compare& comp) {
+        size_t low = d > k ? d - k : 0;
+        size_t high = std::min(d, m);
+        while (low < high) {
+            const size_t i = low + (high - low) / 2;
+            if (!comp(b[d - i - 1], a[i])) {
+                low = i + 1;
+            } else {
+                high = i;
+            }
+        }
+        return low;
+    }
+
+    // Сливает пары соседних отсортированных кусков длины width из from в to. Каждая пара делится
+    // на части поровну по длине результата, поэтому последние слияния тоже идут в несколько потоков.
+    // Границы частей ищутся заранее: слияние переносит элементы, и поиск во время него читал бы
+    // уже перенесённые объекты соседней части
+    template <typename T, typename Compare>
+    void MergeRound(T* from, T* to, size_t n, size_t width, Compare& comp, size_t threads) {
+        const size_t pairs = (n + 2 * width - 1) / (2 * width);
+        const size_t parts = std::max<size_t>(1, threads / pairs);
+        const size_t tasks = pairs * parts;
+        // Для части task: сколько элементов первого куска пары идёт в результат до её начала
+        std::vector<size_t> splits(tasks);
+        const auto pair_bounds = [=](size_t pair) {
+            const size_t begin = pair * 2 * width;
+            return std::make_tuple(begin, std::min(begin + width, n), std::min(begin + 2 * width, n));
+        };
+        for (size_t task = 0; task < tasks; ++task) {
+            const auto [begin, mid, end] = pair_bounds(task / parts);
+            const size_t d = (end - begin) * (task % parts) / parts;
+            splits[task] = MergeSplit(from + begin, mid - begin, from + mid, end - mid, d, comp);
+        }
+
+        const auto merge = [=, &splits, &comp](size_t first_task, size_t count) {
+            for (size_t task = first_task; task < first_task + count; ++task) {
+                const auto [begin, mid, end] = pair_bounds(task / parts);
+                const size_t part = task % parts;
+                const size_t d_begin = (end - begin) * part / parts;
+                const size_t d_end = (end - begin) * (part + 1) / parts;
+                const size_t i_begin = splits[task];
+                const size_t i_end = part + 1 < parts ? splits[task + 1] : mid - begin;
+                T* a = from + begin;
+                T* b = from + mid;
+                std::merge(std::make_move_iterator(a + i_begin), std::make_move_iterator(a + i_end),
+                           std::make_move_iterator(b + (d_begin - i_begin)),
+                           std::make_move_iterator(b + (d_end - i_end)), to + begin + d_begin, comp);
+            }
+        };
+        ParallelFor(tasks, std::min(tasks, threads), merge);
+    }
+
+    // Сортирует data[0, n) слиянием: куски по run_size элементов упорядочивает sort_run(first, count, scratch)
+    // в threads потоках, затем пары кусков сливаются поочерёдно через scratch и обратно. Перед слияниями
+    // элементы переносятся в scratch, так что обе половины всегда состоят из живых объектов; при исключении
+    // из comp элементы остаются в неуказанном порядке (часть может быть в состоянии после переноса)
+    template <typename T, typename Compare, typename SortRun>
+    void MergeSort(T* data, size_t n, T* scratch, size_t run_size, Compare& comp, size_t threads, SortRun sort_run) {
+        const size_t runs = (n + run_size - 1) / run_size;
+        ParallelFor(runs, std::min(runs, threads), [=](size_t first, size_t count) {
+            for (size_t run = first; run < first + count; ++run) {
+                const size_t offset = run * run_size;
+                sort_run(data + offset, std::min(run_size, n - offset), scratch + offset);
+            }
+        });
+        if (runs <= 1) {
+            return;
+        }
+
+        if constexpr (std::is_trivially_copyable_v<T>) {
+            std::memcpy(static_cast<void*>(scratch), static_cast<const void*>(data), n * sizeof(T));
+        } else {
+            std::uninitialized_move_n(data, n, scratch);
+        }
+        T* from = scratch;
+        T* to = data;
+        try {
+            for (size_t width = run_size; width < n; width *= 2) {
+                MergeRound(from, to, n, width, comp, threads);
+                std::swap(from, to);
+            }
+            if (from != data) {
+                ParallelFor(n, threads, [from, data](size_t offset, size_t count) {
+                    std::move(from + offset, from + offset + count, data + offset);
+                });
+            }
+        } catch (...) {
+            std::destroy_n(scratch, n);
+            throw;
+        }
+        std::destroy_n(scratch, n);
+    }
+
+    // Неустойчивая сортировка: поразрядная для чисел со сравнением по умолчанию, иначе std::sort.
+    // В несколько потоков куски сортируются независимо и затем сливаются
+    template <typename T, typename Compare>
+    void Sort(T* data, size_t n, T* scratch, Compare& comp, size_t threads) {
+        const auto sort_run = [&comp](T* first, size_t count, T* run_scratch) {
+            if constexpr (kRadixSortable<T> && kIsDefaultLess<Compare, T>) {
+                if (count >= kRadixSortThreshold) {
+                    RadixSort(first, count, run_scratch);
+                    return;
+                }
+            }
+            std::sort(first, first + count, comp);
+        };
+        if (threads <= 1) {
+            sort_run(data, n, scratch);
+            return;
+        }
+        MergeSort(data, n, scratch, (n + threads - 1) / threads, comp, threads, sort_run);
+    }
+
+    // Устойчивая сортировка без выделения памяти. Поразрядная только для целых: у чисел с плавающей
+    // точкой она различает -0.0 и +0.0, которые для std::less равны
+    template <typename T, typename Compare>
+    void StableSort(T* data, size_t n, T* scratch, Compare& comp, size_t threads) {
+        const auto sort_run = [&comp](T* first, size_t count, T* run_scratch) {
+            if constexpr (kRadixSortable<T> && std::is_integral_v<T> && kIsDefaultLess<Compare, T>) {
+                if (count >= kRadixSortThreshold) {
+                    RadixSort(first, count, run_scratch);
+                    return;
+                }
+            }
+            MergeSort(first, count, run_scratch, kInsertionSortRun, comp, 1,
+                      [&comp](T* run_first, size_t run_count, T*) {
+                          InsertionSort(run_first, run_count, comp);
+                      });
+        };
+        if (threads <= 1) {
+            sort_run(data, n, scratch);
+            return;
+        }
+        MergeSort(data, n, scratch, (n + threads - 1) / threads, comp, threads, sort_run);
+    }
+
+}  // namespace detail
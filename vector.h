@@ -1,48 +1,592 @@
 #pragma once
+#include "parallel.h"
+#include "simd.h"
+#include "sort.h"
+#include "vector_check.h"
+
 #include <cassert>
 #include <cstdlib>
+#include <cstring>
 #include <new>
 #include <utility>
 #include <memory>
 #include <algorithm>
+#include <atomic>
+#include <functional>
+#include <initializer_list>
+#include <iterator>
+#include <memory_resource>
+#include <type_traits>
+
+
+// Тип тривиально перемещаем, если объект можно перенести в другую память побайтовым копированием,
+// не вызывая затем деструктор исходного объекта. По умолчанию это верно для тривиально копируемых типов;
+// для остальных (например, обёрток над std::unique_ptr) шаблон можно специализировать.
+template <typename T>
+struct IsTriviallyRelocatable : std::is_trivially_copyable<T> {
+};
+
+template <typename T>
+struct IsTriviallyRelocatable<std::unique_ptr<T>> : std::true_type {
+};
+
+template <typename T>
+inline constexpr bool IsTriviallyRelocatableV = IsTriviallyRelocatable<T>::value;
+
+// Тип обнуляем, если T{} состоит из нулевых байтов и создание со значением по умолчанию можно заменить
+// memset. Верно для чисел, перечислений и указателей; для своих типов шаблон можно специализировать
+template <typename T>
+struct IsZeroInitializable : std::bool_constant<std::is_arithmetic_v<T> || std::is_enum_v<T> || std::is_pointer_v<T>> {
+};
+
+template <typename T>
+inline constexpr bool IsZeroInitializableV = IsZeroInitializable<T>::value;
+
+namespace detail {
+
+// Переносит n элементов из from в неинициализированную память to, исходные объекты уничтожаются.
+// При исключении во время копирования исходные элементы остаются нетронутыми
+template <typename T>
+void RelocateN(T* from, size_t n, T* to) {
+    if constexpr (IsTriviallyRelocatableV<T>) {
+        if (n != 0) {
+            std::memcpy(static_cast<void*>(to), static_cast<const void*>(from), n * sizeof(T));
+        }
+    } else {
+        if constexpr (std::is_nothrow_move_constructible_v<T> || !std::is_copy_constructible_v<T>) {
+            std::uninitialized_move_n(from, n, to);
+        } else {
+            std::uninitialized_copy_n(from, n, to);
+        }
+        std::destroy_n(from, n);
+    }
+}
+
+// Переносит n элементов из from в неинициализированную память to, оставляя в to gap_size свободных
+// ячеек начиная с индекса gap. При исключении исходные элементы остаются нетронутыми,
+// а созданные копии уничтожаются
+template <typename T>
+void RelocateWithGap(T* from, size_t n, size_t gap, T* to, size_t gap_size = 1) {
+    if constexpr (IsTriviallyRelocatableV<T>) {
+        RelocateN(from, gap, to);
+        // Явная проверка пустого хвоста: без неё GCC выводит для memcpy размер из (size_t)-1
+        if (gap != n) {
+            RelocateN(from + gap, n - gap, to + gap + gap_size);
+        }
+    } else {
+        if constexpr (std::is_nothrow_move_constructible_v<T> || !std::is_copy_constructible_v<T>) {
+            std::uninitialized_move_n(from, gap, to);
+            std::uninitialized_move_n(from + gap, n - gap, to + gap + gap_size);
+        } else {
+            std::uninitialized_copy_n(from, gap, to);
+            try {
+                std::uninitialized_copy_n(from + gap, n - gap, to + gap + gap_size);
+            } catch (...) {
+                std::destroy_n(to, gap);
+                throw;
+            }
+        }
+        std::destroy_n(from, n);
+    }
+}
+
+// Проверяет, лежит ли хотя бы один из аргументов внутри массива [first, last).
+// Косвенные ссылки (указатели и итераторы на элементы) не распознаются
+template <typename T, typename... Args>
+bool AnyArgumentWithin(const T* first, const T* last, const Args&... args) noexcept {
+    [[maybe_unused]] const auto within = [first, last](const void* address) {
+        const auto* byte = static_cast<const unsigned char*>(address);
+        return !std::less<const unsigned char*>()(byte, reinterpret_cast<const unsigned char*>(first))
+               && std::less<const unsigned char*>()(byte, reinterpret_cast<const unsigned char*>(last));
+    };
+    return (false || ... || within(std::addressof(args)));
+}
+
+// Создаёт элемент в позиции pos массива data из size элементов, сдвигая хвост на одну ячейку.
+// За последним элементом должна быть свободная ячейка. Если создание элемента выбросит исключение,
+// тривиально перемещаемый массив возвращается в исходное состояние
+template <typename T, typename... Args>
+T* EmplaceInPlace(T* data, size_t size, size_t pos, Args&&... args) {
+    T* current_pos = data + pos;
+    T* end = data + size;
+    if (current_pos == end) {
+        new (current_pos) T (std::forward<Args>(args)...);
+    } else if constexpr (IsTriviallyRelocatableV<T>) {
+        const size_t tail_bytes = (size - pos) * sizeof(T);
+        if (AnyArgumentWithin(data, end, args...)) {
+            // Аргументы сдвинутся вместе с хвостом, поэтому элемент создаётся заранее в сырой памяти
+            alignas(T) unsigned char storage[sizeof(T)];
+            new (storage) T (std::forward<Args>(args)...);
+            std::memmove(static_cast<void*>(current_pos + 1), static_cast<const void*>(current_pos), tail_bytes);
+            std::memcpy(static_cast<void*>(current_pos), static_cast<const void*>(storage), sizeof(T));
+        } else {
+            std::memmove(static_cast<void*>(current_pos + 1), static_cast<const void*>(current_pos), tail_bytes);
+            try {
+                new (current_pos) T (std::forward<Args>(args)...);
+            } catch (...) {
+                std::memmove(static_cast<void*>(current_pos), static_cast<const void*>(current_pos + 1), tail_bytes);
+                throw;
+            }
+        }
+    } else {
+        if constexpr (std::is_nothrow_constructible_v<T, Args&&...>) {
+            if (!AnyArgumentWithin(data, end, args...)) {
+                new (end) T (std::move(*(end - 1)));
+                std::move_backward(current_pos, end - 1, end);
+                current_pos->~T();
+                new (current_pos) T (std::forward<Args>(args)...);
+                return current_pos;
+            }
+        }
+        T temp_el(std::forward<Args>(args)...);
+        new (end) T (std::move(*(end - 1)));
+        std::move_backward(current_pos, end - 1, end);
+        *current_pos = std::move(temp_el);
+    }
+    return current_pos;
+}
+
+// Удаляет элемент в позиции pos массива data из size элементов, сдвигая хвост на его место
+template <typename T>
+T* EraseAt(T* data, size_t size, size_t pos) noexcept(IsTriviallyRelocatableV<T> || std::is_nothrow_move_assignable_v<T>) {
+    T* current_pos = data + pos;
+    if constexpr (IsTriviallyRelocatableV<T>) {
+        current_pos->~T();
+        if (pos + 1 != size) {
+            std::memmove(static_cast<void*>(current_pos), static_cast<const void*>(current_pos + 1),
+                         (size - pos - 1) * sizeof(T));
+        }
+    } else {
+        std::move(current_pos + 1, data + size, current_pos);
+        (data + size - 1)->~T();
+    }
+    return current_pos;
+}
+
+// Копирует count элементов, начиная с first, в неинициализированную память dest.
+// Непрерывный диапазон тривиально копируемых элементов переносится одним memcpy
+template <typename ForwardIt, typename T>
+void CopyConstructN(ForwardIt first, size_t count, T* dest) {
+    if constexpr (std::is_trivially_copyable_v<T>
+                  && (std::is_same_v<ForwardIt, T*> || std::is_same_v<ForwardIt, const T*>)) {
+        if (count != 0) {
+            std::memcpy(static_cast<void*>(dest), static_cast<const void*>(first), count * sizeof(T));
+        }
+    } else {
+        std::uninitialized_copy_n(first, count, dest);
+    }
+}
+
+// Операции над массивом элементов, выбирающие путь по свойствам T во время компиляции: тривиальные
+// деструкторы не вызываются, а создание, копирование и заполнение сводятся к memset и memcpy.
+// Так быстрые пути не зависят от оптимизаций компилятора и работают и в отладочной сборке
 
+template <typename T>
+void DestroyN(T* first, size_t n) noexcept {
+    if constexpr (!std::is_trivially_destructible_v<T>) {
+        std::destroy_n(first, n);
+    }
+}
+
+template <typename T>
+void ValueConstructN(T* dest, size_t n) noexcept(std::is_nothrow_default_constructible_v<T>) {
+    if constexpr (IsZeroInitializableV<T>) {
+        if (n != 0) {
+            std::memset(static_cast<void*>(dest), 0, n * sizeof(T));
+        }
+    } else {
+        std::uninitialized_value_construct_n(dest, n);
+    }
+}
+
+template <typename T>
+void DefaultConstructN(T* dest, size_t n) noexcept(std::is_nothrow_default_constructible_v<T>) {
+    if constexpr (!std::is_trivially_default_constructible_v<T>) {
+        std::uninitialized_default_construct_n(dest, n);
+    }
+}
+
+template <typename T>
+void FillConstructN(T* dest, size_t n, const T& value) noexcept(std::is_nothrow_copy_constructible_v<T>) {
+    if constexpr (std::is_trivially_copyable_v<T> && sizeof(T) == 1) {
+        if (n != 0) {
+            std::memset(static_cast<void*>(dest), *reinterpret_cast<const unsigned char*>(&value), n);
+        }
+    } else {
+        std::uninitialized_fill_n(dest, n, value);
+    }
+}
+
+// Присваивает n элементов из src в непересекающийся массив живых элементов dest
+template <typename T>
+void CopyAssignN(const T* src, size_t n, T* dest) noexcept(std::is_nothrow_copy_assignable_v<T>) {
+    if constexpr (std::is_trivially_copy_assignable_v<T> && std::is_trivially_copyable_v<T>) {
+        if (n != 0) {
+            std::memcpy(static_cast<void*>(dest), static_cast<const void*>(src), n * sizeof(T));
+        }
+    } else {
+        std::copy_n(src, n, dest);
+    }
+}
+
+// Переносит n элементов в неинициализированную память dest, оставляя исходные элементы живыми
+template <typename T>
+void MoveConstructN(T* src, size_t n, T* dest) noexcept(std::is_nothrow_move_constructible_v<T>) {
+    if constexpr (std::is_trivially_copyable_v<T>) {
+        CopyConstructN(static_cast<const T*>(src), n, dest);
+    } else {
+        std::uninitialized_move_n(src, n, dest);
+    }
+}
 
+// Прямой итератор по последовательности из одного и того же значения
 template <typename T>
-class RawMemory {
+class RepeatIterator {
 public:
+    using iterator_category = std::forward_iterator_tag;
+    using value_type = T;
+    using difference_type = std::ptrdiff_t;
+    using pointer = const T*;
+    using reference = const T&;
+
+    RepeatIterator(const T* value, size_t index) noexcept
+            : value_(value)
+            , index_(index) {
+    }
+
+    reference operator*() const noexcept {
+        return *value_;
+    }
+    pointer operator->() const noexcept {
+        return value_;
+    }
+    RepeatIterator& operator++() noexcept {
+        ++index_;
+        return *this;
+    }
+    RepeatIterator operator++(int) noexcept {
+        RepeatIterator old = *this;
+        ++index_;
+        return old;
+    }
+    bool operator==(const RepeatIterator& other) const noexcept {
+        return index_ == other.index_;
+    }
+    bool operator!=(const RepeatIterator& other) const noexcept {
+        return index_ != other.index_;
+    }
+
+private:
+    const T* value_;
+    size_t index_;
+};
+
+template <typename It>
+using RequireInputIterator = std::enable_if_t<std::is_convertible_v<
+        typename std::iterator_traits<It>::iterator_category, std::input_iterator_tag>>;
+
+// Удаляет элементы [first, last) массива data из size элементов, сдвигая хвост за один проход
+template <typename T>
+T* EraseRange(T* data, size_t size, size_t first, size_t last) {
+    T* erase_first = data + first;
+    T* erase_last = data + last;
+    T* end = data + size;
+    if constexpr (IsTriviallyRelocatableV<T>) {
+        std::destroy(erase_first, erase_last);
+        if (erase_last != end) {
+            std::memmove(static_cast<void*>(erase_first), static_cast<const void*>(erase_last),
+                         (end - erase_last) * sizeof(T));
+        }
+    } else {
+        std::destroy(std::move(erase_last, end, erase_first), end);
+    }
+    return erase_first;
+}
+
+// Удаляет из массива data из size элементов те, для которых pred вернул true, за один проход,
+// и записывает в size новый размер. Если pred выбросит исключение, массив остаётся плотным,
+// а size учитывает уже удалённые элементы
+template <typename T, typename Predicate>
+void EraseIf(T* data, size_t& size, Predicate& pred) {
+    if constexpr (IsTriviallyRelocatableV<T>) {
+        size_t write = 0;
+        size_t read = 0;
+        try {
+            for (; read < size; ++read) {
+                if (pred(std::as_const(data[read]))) {
+                    data[read].~T();
+                } else {
+                    if (write != read) {
+                        std::memcpy(static_cast<void*>(data + write), static_cast<const void*>(data + read), sizeof(T));
+                    }
+                    ++write;
+                }
+            }
+        } catch (...) {
+            std::memmove(static_cast<void*>(data + write), static_cast<const void*>(data + read),
+                         (size - read) * sizeof(T));
+            size = write + (size - read);
+            throw;
+        }
+        size = write;
+    } else {
+        T* new_end = std::remove_if(data, data + size, [&pred](const T& value) {
+            return pred(value);
+        });
+        std::destroy(new_end, data + size);
+        size = new_end - data;
+    }
+}
+
+// Удаляет элементы [first, last) массива data из size элементов, перенося на их место элементы
+// с конца массива. Порядок оставшихся элементов не сохраняется, зато сдвигается не больше last - first элементов
+template <typename T>
+T* EraseUnorderedRange(T* data, size_t size, size_t first, size_t last) {
+    const size_t count = last - first;
+    const size_t moved = std::min(count, size - last);
+    if constexpr (IsTriviallyRelocatableV<T>) {
+        std::destroy(data + first, data + last);
+        if (moved != 0) {
+            std::memcpy(static_cast<void*>(data + first), static_cast<const void*>(data + size - moved),
+                        moved * sizeof(T));
+        }
+    } else {
+        std::move(data + size - moved, data + size, data + first);
+        std::destroy(data + size - count, data + size);
+    }
+    return data + first;
+}
+
+// Аллокатор умеет расширять ранее выделенный блок: T* reallocate(T* p, size_t old_n, size_t new_n).
+// При неудаче reallocate возвращает nullptr, и блок p остаётся действительным
+template <typename Alloc, typename T, typename = void>
+struct HasReallocate : std::false_type {
+};
+
+template <typename Alloc, typename T>
+struct HasReallocate<Alloc, T, std::void_t<decltype(std::declval<Alloc&>().reallocate(
+        std::declval<T*>(), std::declval<size_t>(), std::declval<size_t>()))>> : std::true_type {
+};
+
+// Сравнение элементов на равенство не бросает исключений
+template <typename T>
+inline constexpr bool kNothrowEqual = noexcept(std::declval<const T&>() == std::declval<const T&>());
+
+}  // namespace detail
+
+// Политика учёта вызывается контейнером при выделении буфера, его росте с переносом элементов
+// и освобождении. Пустая политика NoVectorStats полностью исчезает при компиляции
+struct NoVectorStats {
+    static void OnAllocate(size_t /*bytes*/) noexcept {
+    }
+    static void OnReallocate(size_t /*relocated_elements*/) noexcept {
+    }
+    static void OnRelease(size_t /*capacity_bytes*/, size_t /*used_bytes*/) noexcept {
+    }
+};
+
+// Счётчики, общие для всех векторов с одним и тем же тегом Tag.
+// Тег различает места использования: Vector<T, Alloc, Growth, VectorStats<struct RequestIdsTag>>
+template <typename Tag>
+class VectorStats {
+public:
+    struct Snapshot {
+        size_t allocations = 0;
+        size_t bytes_allocated = 0;
+        size_t reallocations = 0;
+        size_t elements_relocated = 0;
+        size_t buffers_released = 0;
+        // Незанятая ёмкость освобождённых буферов
+        size_t wasted_bytes = 0;
+    };
+
+    static void OnAllocate(size_t bytes) noexcept {
+        allocations_.fetch_add(1, std::memory_order_relaxed);
+        bytes_allocated_.fetch_add(bytes, std::memory_order_relaxed);
+    }
+
+    static void OnReallocate(size_t relocated_elements) noexcept {
+        reallocations_.fetch_add(1, std::memory_order_relaxed);
+        elements_relocated_.fetch_add(relocated_elements, std::memory_order_relaxed);
+    }
+
+    static void OnRelease(size_t capacity_bytes, size_t used_bytes) noexcept {
+        buffers_released_.fetch_add(1, std::memory_order_relaxed);
+        wasted_bytes_.fetch_add(capacity_bytes - used_bytes, std::memory_order_relaxed);
+    }
+
+    static Snapshot Get() noexcept {
+        Snapshot snapshot;
+        snapshot.allocations = allocations_.load(std::memory_order_relaxed);
+        snapshot.bytes_allocated = bytes_allocated_.load(std::memory_order_relaxed);
+        snapshot.reallocations = reallocations_.load(std::memory_order_relaxed);
+        snapshot.elements_relocated = elements_relocated_.load(std::memory_order_relaxed);
+        snapshot.buffers_released = buffers_released_.load(std::memory_order_relaxed);
+        snapshot.wasted_bytes = wasted_bytes_.load(std::memory_order_relaxed);
+        return snapshot;
+    }
+
+    static void Reset() noexcept {
+        allocations_.store(0, std::memory_order_relaxed);
+        bytes_allocated_.store(0, std::memory_order_relaxed);
+        reallocations_.store(0, std::memory_order_relaxed);
+        elements_relocated_.store(0, std::memory_order_relaxed);
+        buffers_released_.store(0, std::memory_order_relaxed);
+        wasted_bytes_.store(0, std::memory_order_relaxed);
+    }
+
+private:
+    static inline std::atomic<size_t> allocations_{0};
+    static inline std::atomic<size_t> bytes_allocated_{0};
+    static inline std::atomic<size_t> reallocations_{0};
+    static inline std::atomic<size_t> elements_relocated_{0};
+    static inline std::atomic<size_t> buffers_released_{0};
+    static inline std::atomic<size_t> wasted_bytes_{0};
+};
+
+// Тег конструктора, создающего элементы инициализацией по умолчанию вместо инициализации значением:
+// для тривиальных типов память не заполняется нулями
+struct DefaultInitTag {
+    explicit DefaultInitTag() = default;
+};
+
+inline constexpr DefaultInitTag kDefaultInit{};
+
+inline constexpr size_t kCacheLineSize = 64;
+inline constexpr size_t kPageSize = 4096;
+
+// Политика роста определяет ёмкость нового буфера, когда в буфере ёмкостью capacity
+// не хватает места под required элементов размером element_size байт:
+// static size_t NextCapacity(size_t capacity, size_t required, size_t element_size)
+
+// Удвоение ёмкости, начиная с одного элемента
+struct DoublingGrowth {
+    static constexpr size_t NextCapacity(size_t capacity, size_t required, size_t /*element_size*/) noexcept {
+        return std::max(required, capacity == 0 ? 1 : capacity * 2);
+    }
+};
+
+// Рост в Num/Den раз. Первый буфер занимает не меньше MinBytes, а буферы от PageRoundBytes
+// округляются вверх до целого числа страниц. При множителе меньше золотого сечения сумма
+// освобождённых блоков со временем превышает новый запрос, и аллокатор может их переиспользовать
+template <size_t Num, size_t Den, size_t MinBytes = kCacheLineSize, size_t PageRoundBytes = 16 * kPageSize>
+struct GeometricGrowth {
+    static_assert(Den > 0 && Num > Den, "growth factor must be greater than 1");
+
+    static constexpr size_t NextCapacity(size_t capacity, size_t required, size_t element_size) noexcept {
+        size_t next = capacity / Den * Num + capacity % Den * Num / Den;
+        next = std::max({next, capacity + 1, required, MinBytes / element_size});
+        if (next * element_size >= PageRoundBytes) {
+            const size_t bytes = (next * element_size + kPageSize - 1) / kPageSize * kPageSize;
+            next = bytes / element_size;
+        }
+        return next;
+    }
+};
+
+using FactorOneAndHalfGrowth = GeometricGrowth<3, 2>;
+
+// Освобождает чужой буфер ёмкостью capacity элементов, переданный в RawMemory::Adopt. Не должен бросать исключений
+template <typename T>
+using BufferDeleter = std::function<void(T* buffer, size_t capacity)>;
+
+// Буфер, отданный контейнером вместе с ответственностью за него: первые size элементов сконструированы,
+// их нужно уничтожить, а память вернуть вызовом deleter(data, capacity)
+template <typename T>
+struct ExternalBuffer {
+    T* data = nullptr;
+    size_t size = 0;
+    size_t capacity = 0;
+    BufferDeleter<T> deleter;
+};
+
+// Политика владения буфером RawMemory и Vector. По умолчанию (OwnedBuffers) буфер всегда получен
+// от аллокатора, и политика ничего не хранит. AdoptableBuffers разрешает ещё и Adopt чужих буферов:
+// их BufferDeleter лежит в куче, а контейнер платит за это одним указателем
+struct OwnedBuffers {};
+struct AdoptableBuffers {};
+
+namespace detail {
+
+template <typename T, typename Ownership>
+struct BufferDeleterSlot {
+};
+
+template <typename T>
+struct BufferDeleterSlot<T, AdoptableBuffers> {
+    std::unique_ptr<BufferDeleter<T>> adopted_deleter;
+};
+
+}  // namespace detail
+
+// Аллокатор задаёт только источник сырой памяти (std::allocator_traits::allocate/deallocate),
+// элементы по-прежнему конструируются на месте размещающим new.
+// Пустой аллокатор (std::allocator) за счёт EBO не увеличивает размер RawMemory.
+// Чужие буферы (Adopt) принимаются только с политикой AdoptableBuffers, иначе место под их
+// BufferDeleter тоже убирает EBO
+template <typename T, typename Alloc = std::allocator<T>, typename Ownership = OwnedBuffers>
+class RawMemory : private Alloc, private detail::BufferDeleterSlot<T, Ownership> {
+    using AllocTraits = std::allocator_traits<Alloc>;
+    using DeleterSlot = detail::BufferDeleterSlot<T, Ownership>;
+    static constexpr bool kAdoptable = std::is_same_v<Ownership, AdoptableBuffers>;
+    static_assert(std::is_same_v<typename AllocTraits::value_type, T>,
+                  "Alloc::value_type must be T");
+
+public:
+    using allocator_type = Alloc;
+
     RawMemory() = default;
 
-    explicit RawMemory(size_t capacity)
-            : buffer_(Allocate(capacity))
+    explicit RawMemory(const Alloc& alloc) noexcept
+            : Alloc(alloc) {
+    }
+
+    explicit RawMemory(size_t capacity, const Alloc& alloc = Alloc())
+            : Alloc(alloc)
+            , buffer_(Allocate(capacity))
             , capacity_(capacity) {
+        NewGeneration();
     }
     RawMemory(const RawMemory&) = delete;
     RawMemory& operator=(const RawMemory&) = delete;
 
-    RawMemory(RawMemory&& other) noexcept: buffer_(std::move(other.buffer_)), capacity_(std::move(other.capacity_)) {
-        other.buffer_ = nullptr;
-        other.capacity_ = 0;
+    RawMemory(RawMemory&& other) noexcept
+            : Alloc(std::move(other.GetAllocator()))
+            , DeleterSlot(std::move(static_cast<DeleterSlot&>(other)))
+            , buffer_(std::exchange(other.buffer_, nullptr))
+            , capacity_(std::exchange(other.capacity_, 0)) {
+#if VECTOR_CHECK_LEVEL >= 2
+        generation_ = std::exchange(other.generation_, 0);
+#endif
     }
 
+    // Аллокатор переносится только если этого требует propagate_on_container_move_assignment,
+    // иначе вызывающий код обязан гарантировать равенство аллокаторов
     RawMemory& operator=(RawMemory&& other) noexcept {
-        buffer_ = std::move(other.buffer_);
-        capacity_ = std::move(other.capacity_);
-
-        other.buffer_ = nullptr;
-        other.capacity_ = 0;
+        if (this == &other) {
+            return *this;
+        }
+        Free();
+        if constexpr (AllocTraits::propagate_on_container_move_assignment::value) {
+            GetAllocator() = std::move(other.GetAllocator());
+        }
+        buffer_ = std::exchange(other.buffer_, nullptr);
+        capacity_ = std::exchange(other.capacity_, 0);
+        static_cast<DeleterSlot&>(*this) = std::move(static_cast<DeleterSlot&>(other));
+#if VECTOR_CHECK_LEVEL >= 2
+        generation_ = std::exchange(other.generation_, 0);
+#endif
 
         return *this;
     }
 
     ~RawMemory() {
-        if (capacity_ > 0){
-            Deallocate(buffer_);
-        }
+        Free();
     }
 
     T* operator+(size_t offset) noexcept {
         // Разрешается получать адрес ячейки памяти, следующей за последним элементом массива
-        assert(offset <= capacity_);
+        VECTOR_CHECK(offset <= capacity_);
         return buffer_ + offset;
     }
 
@@ -55,13 +599,41 @@ public:
     }
 
     T& operator[](size_t index) noexcept {
-        assert(index < capacity_);
+        VECTOR_CHECK(index < capacity_);
         return buffer_[index];
     }
 
     void Swap(RawMemory& other) noexcept {
+        if constexpr (AllocTraits::propagate_on_container_swap::value) {
+            using std::swap;
+            swap(GetAllocator(), other.GetAllocator());
+        }
         std::swap(buffer_, other.buffer_);
         std::swap(capacity_, other.capacity_);
+        if constexpr (kAdoptable) {
+            DeleterSlot::adopted_deleter.swap(other.adopted_deleter);
+        }
+#if VECTOR_CHECK_LEVEL >= 2
+        std::swap(generation_, other.generation_);
+#endif
+    }
+
+    // Освобождает текущий буфер и принимает чужой буфер на capacity элементов, который потом будет
+    // освобождён вызовом deleter. Если принять буфер не удалось, он сразу отдаётся deleter.
+    // Доступно только с политикой AdoptableBuffers
+    void Adopt(T* buffer, size_t capacity, BufferDeleter<T> deleter);
+
+    // Отдаёт буфер вызывающему вместе с функцией его освобождения, RawMemory остаётся пустым.
+    // Для памяти собственного аллокатора функция хранит копию аллокатора
+    ExternalBuffer<T> Release();
+
+    // Буфер получен через Adopt и не принадлежит аллокатору
+    bool IsAdopted() const noexcept {
+        if constexpr (kAdoptable) {
+            return DeleterSlot::adopted_deleter != nullptr;
+        } else {
+            return false;
+        }
     }
 
     const T* GetAddress() const noexcept {
@@ -76,44 +648,177 @@ public:
         return capacity_;
     }
 
+#if VECTOR_CHECK_LEVEL >= 2
+    // Номер текущего буфера, по которому итераторы узнают о его замене (см. vector_check.h)
+    uint64_t Generation() const noexcept {
+        return generation_;
+    }
+
+    // Выдаёт тому же буферу новый номер: после удаления элементов старые итераторы перестают проходить проверку
+    void Renumber() noexcept {
+        NewGeneration();
+    }
+#endif
+
+    // Пытается расширить буфер до capacity элементов средствами аллокатора (realloc, mremap),
+    // сохраняя его байтовое содержимое. Буфер может переехать, поэтому метод годится только для
+    // тривиально перемещаемых T. При неудаче буфер остаётся прежним
+    bool TryExtend(size_t capacity) noexcept {
+        return capacity > capacity_ && TryReallocate(capacity);
+    }
+
+    // То же для уменьшения буфера до capacity элементов; первые capacity элементов сохраняются
+    bool TryShrink(size_t capacity) noexcept {
+        return capacity != 0 && capacity < capacity_ && TryReallocate(capacity);
+    }
+
+    const Alloc& GetAllocator() const noexcept {
+        return *this;
+    }
+
+    Alloc& GetAllocator() noexcept {
+        return *this;
+    }
+
 private:
+    bool TryReallocate(size_t capacity) noexcept {
+        static_assert(IsTriviallyRelocatableV<T>);
+        if constexpr (detail::HasReallocate<Alloc, T>::value) {
+            if (buffer_ == nullptr || IsAdopted()) {
+                return false;
+            }
+            T* new_buffer = GetAllocator().reallocate(buffer_, capacity_, capacity);
+            if (new_buffer == nullptr) {
+                return false;
+            }
+            buffer_ = new_buffer;
+            capacity_ = capacity;
+            NewGeneration();
+            return true;
+        } else {
+            return false;
+        }
+    }
+
     // Выделяет сырую память под n элементов и возвращает указатель на неё
-    static T* Allocate(size_t n) {
-        return n != 0 ? static_cast<T*>(operator new(n * sizeof(T))) : nullptr;
+    T* Allocate(size_t n) {
+        return n != 0 ? AllocTraits::allocate(GetAllocator(), n) : nullptr;
     }
 
-    // Освобождает сырую память, выделенную ранее по адресу buf при помощи Allocate
-    static void Deallocate(T* buf) noexcept {
+    // Освобождает сырую память под n элементов, выделенную ранее по адресу buf при помощи Allocate
+    void Deallocate(T* buf, size_t n) noexcept {
         if (buf == nullptr) return;
-        operator delete(buf);
+        AllocTraits::deallocate(GetAllocator(), buf, n);
+    }
+
+    // Освобождает текущий буфер тем способом, которым он был получен
+    void Free() noexcept {
+        if constexpr (kAdoptable) {
+            if (IsAdopted()) {
+                (*DeleterSlot::adopted_deleter)(buffer_, capacity_);
+                DeleterSlot::adopted_deleter.reset();
+                return;
+            }
+        }
+        Deallocate(buffer_, capacity_);
+    }
+
+    void NewGeneration() noexcept {
+#if VECTOR_CHECK_LEVEL >= 2
+        generation_ = buffer_ != nullptr ? detail::NextBufferGeneration() : 0;
+#endif
     }
 
     T* buffer_ = nullptr;
     size_t capacity_ = 0;
+#if VECTOR_CHECK_LEVEL >= 2
+    uint64_t generation_ = 0;
+#endif
 };
 
+template <typename T, typename Alloc, typename Ownership>
+void RawMemory<T, Alloc, Ownership>::Adopt(T* buffer, size_t capacity, BufferDeleter<T> deleter) {
+    static_assert(kAdoptable, "adopting foreign buffers requires the AdoptableBuffers ownership policy");
+    VECTOR_CHECK(deleter);
+    std::unique_ptr<BufferDeleter<T>> holder;
+    try {
+        holder = std::make_unique<BufferDeleter<T>>(std::move(deleter));
+    } catch (...) {
+        deleter(buffer, capacity);
+        throw;
+    }
+    Free();
+    buffer_ = buffer;
+    capacity_ = capacity;
+    DeleterSlot::adopted_deleter = std::move(holder);
+    NewGeneration();
+}
 
+template <typename T, typename Alloc, typename Ownership>
+ExternalBuffer<T> RawMemory<T, Alloc, Ownership>::Release() {
+    ExternalBuffer<T> released;
+    if (IsAdopted()) {
+        if constexpr (kAdoptable) {
+            released.deleter = std::move(*DeleterSlot::adopted_deleter);
+            DeleterSlot::adopted_deleter.reset();
+        }
+    } else if (buffer_ != nullptr) {
+        released.deleter = [alloc = GetAllocator()](T* buffer, size_t capacity) mutable {
+            AllocTraits::deallocate(alloc, buffer, capacity);
+        };
+    }
+    released.data = std::exchange(buffer_, nullptr);
+    released.capacity = std::exchange(capacity_, 0);
+    NewGeneration();
+    return released;
+}
 
-template <typename T>
+
+
+template <typename T, typename Alloc = std::allocator<T>, typename Growth = DoublingGrowth,
+          typename Stats = NoVectorStats, typename Ownership = OwnedBuffers>
 class Vector {
+    using AllocTraits = std::allocator_traits<Alloc>;
+
 public:
+    using allocator_type = Alloc;
+
     Vector() = default;
-    explicit Vector(size_t size);
+    explicit Vector(const Alloc& alloc) noexcept;
+    explicit Vector(size_t size, const Alloc& alloc = Alloc());
+    Vector(size_t size, DefaultInitTag, const Alloc& alloc = Alloc());
     Vector(const Vector& other);
+    Vector(const Vector& other, const Alloc& alloc);
     Vector(Vector&& other) noexcept;
+    // Параллельные варианты (см. parallel.h): элементы создаются кусками в нескольких потоках.
+    // При исключении уничтожаются только уже построенные куски
+    Vector(size_t size, const ParallelPolicy& policy, const Alloc& alloc = Alloc());
+    Vector(size_t size, const T& value, const ParallelPolicy& policy, const Alloc& alloc = Alloc());
+    Vector(const Vector& other, const ParallelPolicy& policy);
     ~Vector();
 
+#if VECTOR_CHECK_LEVEL >= 2
+    using iterator = detail::CheckedIterator<Vector, T>;
+    using const_iterator = detail::CheckedIterator<Vector, const T>;
+#else
     using iterator = T*;
     using const_iterator = const T*;
+#endif
 
     Vector& operator=(const Vector& other);
-    Vector& operator=(Vector&& other) noexcept;
+    Vector& operator=(Vector&& other) noexcept(AllocTraits::propagate_on_container_move_assignment::value
+                                               || AllocTraits::is_always_equal::value);
 
     void Swap(Vector& other) noexcept;
 
     void Reserve(size_t capacity);
 
     void Resize(size_t new_size);
+    void Resize(size_t new_size, const ParallelPolicy& policy);
+    // Новые элементы инициализируются по умолчанию: тривиальные типы остаются с неопределённым значением
+    void ResizeDefaultInit(size_t new_size);
+    // То же, что ResizeDefaultInit, но только для тривиальных типов, где элементы гарантированно не трогаются
+    void ResizeUninitialized(size_t new_size);
     void PushBack(const T& value);
     void PushBack(T&& value);
     void PopBack() noexcept;
@@ -131,20 +836,31 @@ public:
         return data_.Capacity();
     }
 
+    Alloc GetAllocator() const noexcept {
+        return data_.GetAllocator();
+    }
+
     const T& operator[](size_t index) const noexcept {
         return const_cast<Vector&>(*this)[index];
     }
 
     T& operator[](size_t index) noexcept {
-        assert(index < size_);
-        return data_[index];
+        VECTOR_CHECK(index < size_);
+        return data_.GetAddress()[index];
     }
 
-    iterator begin() noexcept {
+    T* Data() noexcept {
+        return data_.GetAddress();
+    }
+    const T* Data() const noexcept {
         return data_.GetAddress();
     }
+
+    iterator begin() noexcept {
+        return MakeIterator(data_.GetAddress());
+    }
     iterator end() noexcept {
-        return data_ + size_;
+        return MakeIterator(data_.GetAddress() + size_);
     }
     const_iterator begin() const noexcept {
         return cbegin();
@@ -153,110 +869,305 @@ public:
         return cend();
     }
     const_iterator cbegin() const noexcept {
-        return data_.GetAddress();
+        return MakeIterator(data_.GetAddress());
     }
     const_iterator cend() const noexcept {
-        return data_ + size_;
+        return MakeIterator(data_.GetAddress() + size_);
     }
 
     template<typename... Args>
     iterator Emplace(const_iterator pos, Args&&... args);
-    iterator Erase(const_iterator pos);
+    // Тривиально перемещаемые элементы сдвигаются memmove, поэтому удаление не бросает исключений
+    iterator Erase(const_iterator pos) noexcept(kNothrowErase);
+    iterator Erase(const_iterator first, const_iterator last) noexcept(kNothrowErase);
+    // Удаляет все элементы, удовлетворяющие pred, за один проход и возвращает их количество
+    template<typename Predicate>
+    size_t EraseIf(Predicate pred);
+
+    // Удаление без сохранения порядка: на место удалённых элементов переносятся последние элементы вектора
+    iterator EraseUnordered(const_iterator pos) noexcept(kNothrowErase);
+    iterator EraseUnordered(const_iterator first, const_iterator last) noexcept(kNothrowErase);
+    template<typename Predicate>
+    size_t EraseUnorderedIf(Predicate pred);
     iterator Insert(const_iterator pos, const T& value);
     iterator Insert(const_iterator pos, T&& value);
 
+    // Групповые операции через ядра из simd.h; Fill, Find и Count для прочих T сводятся к std-алгоритмам,
+    // остальные требуют арифметического T
+    void Fill(const T& value) noexcept(std::is_nothrow_copy_assignable_v<T>);
+    iterator Find(const T& value) noexcept(detail::kNothrowEqual<T>);
+    const_iterator Find(const T& value) const noexcept(detail::kNothrowEqual<T>);
+    size_t Count(const T& value) const noexcept(detail::kNothrowEqual<T>);
+    simd::SumType<T> Sum() const noexcept;
+    // Наименьший и наибольший элементы непустого вектора
+    std::pair<T, T> MinMax() const noexcept;
+    template<typename UnaryOp>
+    void Transform(UnaryOp op);
+
+    // Сортировки. Под буфер слияния и поразрядной сортировки идёт свободная ёмкость вектора, если её
+    // не меньше размера, иначе временный буфер. Числа со сравнением по умолчанию сортируются поразрядно.
+    // Параллельные перегрузки делят вектор на policy.ChunkCount(Size()) равных кусков без перехвата
+    // работы (почему — см. sort.h) и вызывают comp из нескольких потоков одновременно
+    template<typename Compare = std::less<>>
+    void Sort(Compare comp = Compare());
+    template<typename Compare = std::less<>>
+    void Sort(const ParallelPolicy& policy, Compare comp = Compare());
+    template<typename Compare = std::less<>>
+    void StableSort(Compare comp = Compare());
+    template<typename Compare = std::less<>>
+    void StableSort(const ParallelPolicy& policy, Compare comp = Compare());
+    // Переставляет элементы, удовлетворяющие pred, в начало; возвращает начало второй группы
+    template<typename Predicate>
+    iterator Partition(Predicate pred);
+    // Ставит на место n тот элемент, который стоял бы там после сортировки
+    template<typename Compare = std::less<>>
+    void NthElement(size_t n, Compare comp = Compare());
+
+    // Удаляет все элементы, сохраняя ёмкость
+    void Clear() noexcept;
+    // Уничтожает элементы в нескольких потоках; перед разрушением огромного вектора
+    void Clear(const ParallelPolicy& policy) noexcept;
+    // Уменьшает ёмкость до размера; пустой вектор отдаёт буфер целиком
+    void ShrinkToFit();
+    // Удаляет все элементы и передаёт буфер вызывающему, вектор остаётся без памяти
+    RawMemory<T, Alloc, Ownership> ReleaseBuffer() noexcept;
+    // Обратная операция: принимает буфер с size уже сконструированными элементами вместо текущего.
+    // Аллокатор буфера должен быть равен аллокатору вектора
+    void AdoptBuffer(RawMemory<T, Alloc, Ownership>&& buffer, size_t size) noexcept;
+
+    // Обмен буферами с чужим кодом без копирования. Adopt уничтожает текущие элементы и принимает буфер
+    // на capacity ячеек, в начале которого уже сконструированы size элементов; память потом вернётся
+    // через deleter. Release отдаёт элементы вместе с буфером, вектор остаётся пустым.
+    // Adopt есть только у векторов с политикой AdoptableBuffers (AdoptingVector), Release — у всех
+    void Adopt(T* data, size_t size, size_t capacity, BufferDeleter<T> deleter);
+    void Adopt(ExternalBuffer<T>&& buffer);
+    ExternalBuffer<T> Release();
+
+    // Групповая вставка: итоговый размер вычисляется заранее, буфер перевыделяется не более одного раза,
+    // а хвост сдвигается один раз. Диапазон для Insert не должен ссылаться на элементы самого вектора
+    template<typename InputIt, typename = detail::RequireInputIterator<InputIt>>
+    void Append(InputIt first, InputIt last);
+    template<typename InputIt, typename = detail::RequireInputIterator<InputIt>>
+    iterator Insert(const_iterator pos, InputIt first, InputIt last);
+    iterator Insert(const_iterator pos, size_t count, const T& value);
+    iterator Insert(const_iterator pos, std::initializer_list<T> values);
+
 private:
-    RawMemory<T> data_;
+    RawMemory<T, Alloc, Ownership> data_;
     size_t size_ = 0;
 
+    static constexpr bool kNothrowErase = IsTriviallyRelocatableV<T> || std::is_nothrow_move_assignable_v<T>;
+
+    // Переход между указателями и итераторами; без проверки итераторов это тождественные функции
+    iterator MakeIterator(T* pointer) noexcept;
+    const_iterator MakeIterator(const T* pointer) const noexcept;
+    // Индекс позиции pos в [0, size_]; позиция проверяется на принадлежность вектору
+    size_t PositionIndex(const_iterator pos) const noexcept;
+    // Вызывается операциями, уменьшающими размер: на уровне проверок 2 все итераторы вектора становятся
+    // недействительными, иначе итератор за новым концом снова прошёл бы проверку после роста
+    void InvalidateIterators() noexcept {
+#if VECTOR_CHECK_LEVEL >= 2
+        data_.Renumber();
+#endif
+    }
+
+#if VECTOR_CHECK_LEVEL >= 2
+    friend iterator;
+    friend const_iterator;
+
+    uint64_t BufferGeneration() const noexcept {
+        return data_.Generation();
+    }
+    bool IsValidIterator(const T* pointer, uint64_t generation, bool dereferenceable) const noexcept;
+#endif
+
+    // Сообщают политике Stats о жизни буферов
+    static RawMemory<T, Alloc, Ownership> AllocateBuffer(size_t capacity, const Alloc& alloc);
+    static void NoteRelease(const RawMemory<T, Alloc, Ownership>& buffer, size_t size) noexcept;
+    void NoteReallocation(size_t relocated_elements) const noexcept;
+
+    // Вызывает fn(scratch) с сырой памятью под size_ элементов: свободной ёмкостью или временным буфером
+    template<typename Fn>
+    void WithScratch(Fn fn);
+
+    template<typename... Args>
+    iterator EmplaceWithReallocation(size_t pos_index, Args&&... args);
+    template<typename ForwardIt>
+    iterator InsertRange(size_t pos_index, ForwardIt first, size_t count);
+    template<typename... Args>
+    bool TryEmplaceExtending(size_t pos_index, size_t new_capacity, Args&&... args);
+
     static void DestroyN(T* buf, size_t n);
     static void Destroy(T* buf);
     static void CopyConstruct(T* buf, const T& value);
 };
 
+// Вектор, память которого берётся из std::pmr::memory_resource (например, monotonic_buffer_resource)
+template <typename T, typename Growth = DoublingGrowth>
+using PmrVector = Vector<T, std::pmr::polymorphic_allocator<T>, Growth>;
 
-template<typename T>
-void Vector<T>::DestroyN(T* buf, size_t n) {
-    for(size_t i = 0; i < n; ++i) {
-        Destroy(buf + i);
-    }
+// Вектор со счётчиками VectorStats<Tag>
+template <typename T, typename Tag, typename Growth = DoublingGrowth>
+using InstrumentedVector = Vector<T, std::allocator<T>, Growth, VectorStats<Tag>>;
+
+// Вектор, принимающий чужие буферы через Adopt
+template <typename T, typename Growth = DoublingGrowth>
+using AdoptingVector = Vector<T, std::allocator<T>, Growth, NoVectorStats, AdoptableBuffers>;
+
+
+template<typename T, typename Alloc, typename Growth, typename Stats, typename Ownership>
+void Vector<T, Alloc, Growth, Stats, Ownership>::DestroyN(T* buf, size_t n) {
+    detail::DestroyN(buf, n);
+}
+
+template<typename T, typename Alloc, typename Growth, typename Stats, typename Ownership>
+typename Vector<T, Alloc, Growth, Stats, Ownership>::iterator Vector<T, Alloc, Growth, Stats, Ownership>::MakeIterator(T* pointer) noexcept {
+#if VECTOR_CHECK_LEVEL >= 2
+    return iterator(pointer, this);
+#else
+    return pointer;
+#endif
 }
 
-template<typename T>
-void Vector<T>::Destroy(T *buf) {
+template<typename T, typename Alloc, typename Growth, typename Stats, typename Ownership>
+typename Vector<T, Alloc, Growth, Stats, Ownership>::const_iterator Vector<T, Alloc, Growth, Stats, Ownership>::MakeIterator(
+        const T* pointer) const noexcept {
+#if VECTOR_CHECK_LEVEL >= 2
+    return const_iterator(pointer, this);
+#else
+    return pointer;
+#endif
+}
+
+// Сравнение указателей, а не разности с приведением к int, поэтому проверка верна для любых размеров
+template<typename T, typename Alloc, typename Growth, typename Stats, typename Ownership>
+size_t Vector<T, Alloc, Growth, Stats, Ownership>::PositionIndex(const_iterator pos) const noexcept {
+#if VECTOR_CHECK_LEVEL >= 2
+    const T* pointer = pos.Base();
+#else
+    const T* pointer = pos;
+#endif
+    const T* first = data_.GetAddress();
+    VECTOR_CHECK(detail::PointerInRange(pointer, first, first + size_));
+    return static_cast<size_t>(pointer - first);
+}
+
+#if VECTOR_CHECK_LEVEL >= 2
+template<typename T, typename Alloc, typename Growth, typename Stats, typename Ownership>
+bool Vector<T, Alloc, Growth, Stats, Ownership>::IsValidIterator(const T* pointer, uint64_t generation,
+                                                       bool dereferenceable) const noexcept {
+    const T* first = data_.GetAddress();
+    const T* last = first + size_;
+    return generation == data_.Generation() && detail::PointerInRange(pointer, first, last)
+           && (!dereferenceable || pointer != last);
+}
+#endif
+
+template<typename T, typename Alloc, typename Growth, typename Stats, typename Ownership>
+void Vector<T, Alloc, Growth, Stats, Ownership>::Destroy(T *buf) {
     buf->~T();
 }
 
-template<typename T>
-void Vector<T>::CopyConstruct(T *buf, const T &value) {
+template<typename T, typename Alloc, typename Growth, typename Stats, typename Ownership>
+void Vector<T, Alloc, Growth, Stats, Ownership>::CopyConstruct(T *buf, const T &value) {
     new (buf) T(value);
 }
 
-template<typename T>
-Vector<T>::Vector(size_t size): data_(size), size_(size) {
-    std::uninitialized_value_construct_n(data_.GetAddress(), size_);
+template<typename T, typename Alloc, typename Growth, typename Stats, typename Ownership>
+Vector<T, Alloc, Growth, Stats, Ownership>::Vector(const Alloc& alloc) noexcept: data_(alloc) {
+}
+
+template<typename T, typename Alloc, typename Growth, typename Stats, typename Ownership>
+Vector<T, Alloc, Growth, Stats, Ownership>::Vector(size_t size, const Alloc& alloc)
+        : data_(AllocateBuffer(size, alloc)), size_(size) {
+    detail::ValueConstructN(data_.GetAddress(), size_);
 }
 
-template<typename T>
-Vector<T>::Vector(const Vector &other): data_(other.size_), size_(other.size_) {
-    std::uninitialized_copy_n(other.data_.GetAddress(), other.size_, data_.GetAddress());
+template<typename T, typename Alloc, typename Growth, typename Stats, typename Ownership>
+Vector<T, Alloc, Growth, Stats, Ownership>::Vector(size_t size, DefaultInitTag, const Alloc& alloc)
+        : data_(AllocateBuffer(size, alloc)), size_(size) {
+    detail::DefaultConstructN(data_.GetAddress(), size_);
 }
 
+template<typename T, typename Alloc, typename Growth, typename Stats, typename Ownership>
+Vector<T, Alloc, Growth, Stats, Ownership>::Vector(const Vector &other)
+        : Vector(other, AllocTraits::select_on_container_copy_construction(other.data_.GetAllocator())) {
+}
 
-template<typename T>
-Vector<T>::~Vector() {
-    std::destroy_n(data_.GetAddress(), size_);
+template<typename T, typename Alloc, typename Growth, typename Stats, typename Ownership>
+Vector<T, Alloc, Growth, Stats, Ownership>::Vector(const Vector &other, const Alloc& alloc)
+        : data_(AllocateBuffer(other.size_, alloc)), size_(other.size_) {
+    detail::CopyConstructN(other.data_.GetAddress(), other.size_, data_.GetAddress());
 }
 
 
-template<typename T>
-void Vector<T>::Reserve(size_t capacity) {
+template<typename T, typename Alloc, typename Growth, typename Stats, typename Ownership>
+Vector<T, Alloc, Growth, Stats, Ownership>::~Vector() {
+    NoteRelease(data_, size_);
+    detail::DestroyN(data_.GetAddress(), size_);
+}
+
+
+template<typename T, typename Alloc, typename Growth, typename Stats, typename Ownership>
+void Vector<T, Alloc, Growth, Stats, Ownership>::Reserve(size_t capacity) {
     if (capacity <= data_.Capacity()) {
         return;
     }
 
-    RawMemory<T> new_buffer(capacity);
-
-    if constexpr (std::is_nothrow_move_constructible_v<T> || !std::is_copy_constructible_v<T>) {
-        std::uninitialized_move_n(data_.GetAddress(), size_, new_buffer.GetAddress());
-    } else {
-        std::uninitialized_copy_n(data_.GetAddress(), size_, new_buffer.GetAddress());
+    if constexpr (IsTriviallyRelocatableV<T>) {
+        if (data_.TryExtend(capacity)) {
+            NoteReallocation(0);
+            return;
+        }
     }
-    std::destroy_n(data_.GetAddress(), size_);
+
+    RawMemory<T, Alloc, Ownership> new_buffer = AllocateBuffer(capacity, data_.GetAllocator());
+
+    detail::RelocateN(data_.GetAddress(), size_, new_buffer.GetAddress());
+    NoteReallocation(size_);
     data_.Swap(new_buffer);
 }
 
 
-template<typename T>
-Vector<T>::Vector(Vector&& other) noexcept: data_(std::move(other.data_)), size_(std::move(other.size_)) {
+template<typename T, typename Alloc, typename Growth, typename Stats, typename Ownership>
+Vector<T, Alloc, Growth, Stats, Ownership>::Vector(Vector&& other) noexcept: data_(std::move(other.data_)), size_(std::move(other.size_)) {
     other.size_ = 0;
 }
 
 
-template<typename T>
-Vector<T>& Vector<T>::operator=(const Vector &other) {
+template<typename T, typename Alloc, typename Growth, typename Stats, typename Ownership>
+Vector<T, Alloc, Growth, Stats, Ownership>& Vector<T, Alloc, Growth, Stats, Ownership>::operator=(const Vector &other) {
     if (&other == this) {
         return *this;
     }
 
+    if constexpr (AllocTraits::propagate_on_container_copy_assignment::value
+                  && !AllocTraits::is_always_equal::value) {
+        if (data_.GetAllocator() != other.data_.GetAllocator()) {
+            // Память, выделенная нашим аллокатором, должна им же и освобождаться
+            NoteRelease(data_, size_);
+            detail::DestroyN(data_.GetAddress(), size_);
+            size_ = 0;
+            {
+                RawMemory<T, Alloc, Ownership> old_buffer(std::move(data_));
+            }
+            data_.GetAllocator() = other.data_.GetAllocator();
+        }
+    }
+
     if (other.size_ > data_.Capacity()) {
-        Vector<T> other_copy(other);
+        Vector other_copy(other, data_.GetAllocator());
         Swap(other_copy);
         return *this;
     }
 
     if (other.size_ < size_) {
-        size_t i = 0;
-        for (; i < other.size_; ++i) {
-            data_[i] = other.data_[i];
-        }
-        std::destroy_n(data_.GetAddress() + i, size_ - i);
+        detail::CopyAssignN(other.data_.GetAddress(), other.size_, data_.GetAddress());
+        detail::DestroyN(data_ + other.size_, size_ - other.size_);
+        InvalidateIterators();
     } else {
-        size_t i = 0;
-        for (; i < size_; ++i) {
-            data_[i] = other.data_[i];
-        }
-        std::uninitialized_copy_n(other.data_.GetAddress() + i, other.size_ - i , data_.GetAddress() + i);
+        detail::CopyAssignN(other.data_.GetAddress(), size_, data_.GetAddress());
+        detail::CopyConstructN(other.data_ + size_, other.size_ - size_, data_ + size_);
     }
     size_ = other.size_;
 
@@ -264,168 +1175,673 @@ Vector<T>& Vector<T>::operator=(const Vector &other) {
 }
 
 
-template<typename T>
-Vector<T>& Vector<T>::operator=(Vector&& other) noexcept {
-    data_ = std::move(other.data_);
-    size_ = std::move(other.size_);
+template<typename T, typename Alloc, typename Growth, typename Stats, typename Ownership>
+Vector<T, Alloc, Growth, Stats, Ownership>& Vector<T, Alloc, Growth, Stats, Ownership>::operator=(Vector&& other)
+        noexcept(AllocTraits::propagate_on_container_move_assignment::value || AllocTraits::is_always_equal::value) {
+    if (&other == this) {
+        return *this;
+    }
 
-    other.size_ = 0;
+    if constexpr (!AllocTraits::propagate_on_container_move_assignment::value
+                  && !AllocTraits::is_always_equal::value) {
+        if (data_.GetAllocator() != other.data_.GetAllocator()) {
+            // Буфер чужого аллокатора забрать нельзя, поэтому элементы переносятся поштучно
+            // в память, выделенную нашим аллокатором
+            RawMemory<T, Alloc, Ownership> new_buffer = AllocateBuffer(other.size_, data_.GetAllocator());
+            detail::MoveConstructN(other.data_.GetAddress(), other.size_, new_buffer.GetAddress());
+            NoteRelease(data_, size_);
+            detail::DestroyN(data_.GetAddress(), size_);
+            data_.Swap(new_buffer);
+            size_ = other.size_;
+            return *this;
+        }
+    }
+
+    NoteRelease(data_, size_);
+    detail::DestroyN(data_.GetAddress(), size_);
+    data_ = std::move(other.data_);
+    size_ = std::exchange(other.size_, 0);
 
     return *this;
 }
 
 
-template<typename T>
-void Vector<T>::Swap(Vector &other) noexcept {
-    std::swap(data_, other.data_);
+template<typename T, typename Alloc, typename Growth, typename Stats, typename Ownership>
+void Vector<T, Alloc, Growth, Stats, Ownership>::Swap(Vector &other) noexcept {
+    data_.Swap(other.data_);
     std::swap(size_, other.size_);
 }
 
-template<typename T>
-void Vector<T>::Resize(size_t new_size) {
+template<typename T, typename Alloc, typename Growth, typename Stats, typename Ownership>
+void Vector<T, Alloc, Growth, Stats, Ownership>::Resize(size_t new_size) {
     if (new_size == size_) return;
 
     if (new_size < size_) {
-        std::destroy_n(data_.GetAddress() + new_size, size_ - new_size);
+        detail::DestroyN(data_ + new_size, size_ - new_size);
+        InvalidateIterators();
     } else {
         Reserve(new_size);
-        std::uninitialized_value_construct_n(data_.GetAddress() + size_, new_size - size_);
+        detail::ValueConstructN(data_ + size_, new_size - size_);
     }
     size_ = new_size;
 }
 
-template<typename T>
-void Vector<T>::PushBack(const T& value) {
-    if (size_ == Capacity()) {
-        RawMemory<T> new_buffer(size_ == 0 ? 1 : size_ * 2);
-        new (new_buffer + size_) T(value);
-
-        if constexpr (std::is_nothrow_move_constructible_v<T> || !std::is_copy_constructible_v<T>) {
-            std::uninitialized_move_n(data_.GetAddress(), size_, new_buffer.GetAddress());
-        } else {
-            std::uninitialized_copy_n(data_.GetAddress(), size_, new_buffer.GetAddress());
-        }
+template<typename T, typename Alloc, typename Growth, typename Stats, typename Ownership>
+void Vector<T, Alloc, Growth, Stats, Ownership>::ResizeDefaultInit(size_t new_size) {
+    if (new_size == size_) return;
 
-        std::destroy_n(data_.GetAddress(), size_);
-        data_.Swap(new_buffer);
+    if (new_size < size_) {
+        detail::DestroyN(data_ + new_size, size_ - new_size);
+        InvalidateIterators();
     } else {
-        new (data_ + size_) T(value);
+        Reserve(new_size);
+        detail::DefaultConstructN(data_ + size_, new_size - size_);
     }
+    size_ = new_size;
+}
+
+template<typename T, typename Alloc, typename Growth, typename Stats, typename Ownership>
+void Vector<T, Alloc, Growth, Stats, Ownership>::ResizeUninitialized(size_t new_size) {
+    static_assert(std::is_trivially_default_constructible_v<T> && std::is_trivially_destructible_v<T>,
+                  "ResizeUninitialized requires a trivial element type");
+    ResizeDefaultInit(new_size);
+}
+
+template<typename T, typename Alloc, typename Growth, typename Stats, typename Ownership>
+void Vector<T, Alloc, Growth, Stats, Ownership>::PushBack(const T& value) {
+    EmplaceBack(value);
+}
+
+template<typename T, typename Alloc, typename Growth, typename Stats, typename Ownership>
+void Vector<T, Alloc, Growth, Stats, Ownership>::PushBack(T&& value) {
+    EmplaceBack(std::move(value));
+}
+
+template<typename T, typename Alloc, typename Growth, typename Stats, typename Ownership>
+void Vector<T, Alloc, Growth, Stats, Ownership>::PopBack() noexcept {
+    VECTOR_CHECK(size_ != 0);
+    data_[--size_].~T();
+    InvalidateIterators();
+}
+
+// Единственный путь роста буфера при вставке: новая ёмкость выбирается политикой Growth,
+// элемент создаётся в новом буфере до переноса старых, чтобы аргументы могли ссылаться на элементы вектора
+template<typename T, typename Alloc, typename Growth, typename Stats, typename Ownership>
+template<typename... Args>
+typename Vector<T, Alloc, Growth, Stats, Ownership>::iterator Vector<T, Alloc, Growth, Stats, Ownership>::EmplaceWithReallocation(size_t pos_index,
+                                                                                          Args&&... args) {
+    const size_t new_capacity = Growth::NextCapacity(Capacity(), size_ + 1, sizeof(T));
+    if (TryEmplaceExtending(pos_index, new_capacity, std::forward<Args>(args)...)) {
+        ++size_;
+        return begin() + pos_index;
+    }
+
+    RawMemory<T, Alloc, Ownership> new_buffer = AllocateBuffer(new_capacity, data_.GetAllocator());
+    T* new_pos = new_buffer + pos_index;
+    new (new_pos) T (std::forward<Args>(args)...);
+
+    try {
+        detail::RelocateWithGap(data_.GetAddress(), size_, pos_index, new_buffer.GetAddress());
+    } catch (...) {
+        new_pos->~T();
+        throw;
+    }
+    NoteReallocation(size_);
+    data_.Swap(new_buffer);
+
     ++size_;
+    return MakeIterator(new_pos);
 }
 
-template<typename T>
-void Vector<T>::PushBack(T&& value) {
-    if (size_ == Capacity()) {
-        RawMemory<T> new_buffer(size_ == 0 ? 1 : size_ * 2);
-        new (new_buffer + size_) T(std::move(value));
+// Вставка с ростом буфера для аллокаторов, умеющих расширять блок на месте.
+// Элемент сначала создаётся во временной сырой памяти, так как аргументы могут ссылаться
+// на элементы вектора, а расширение блока делает такие ссылки недействительными.
+// Возвращает false, не трогая аргументы, если такой путь для T и Alloc неприменим
+template<typename T, typename Alloc, typename Growth, typename Stats, typename Ownership>
+template<typename... Args>
+bool Vector<T, Alloc, Growth, Stats, Ownership>::TryEmplaceExtending(size_t pos_index, size_t new_capacity, Args&&... args) {
+    if constexpr (IsTriviallyRelocatableV<T> && detail::HasReallocate<Alloc, T>::value) {
+        if (data_.GetAddress() == nullptr) {
+            return false;
+        }
 
-        if constexpr (std::is_nothrow_move_constructible_v<T> || !std::is_copy_constructible_v<T>) {
-            std::uninitialized_move_n(data_.GetAddress(), size_, new_buffer.GetAddress());
+        alignas(T) unsigned char storage[sizeof(T)];
+        T* element = new (storage) T(std::forward<Args>(args)...);
+
+        // При вставке в конец хвоста нет, и сдвигать его не нужно
+        const size_t tail = size_ - pos_index;
+        if (data_.TryExtend(new_capacity)) {
+            NoteReallocation(0);
+            if (tail != 0) {
+                std::memmove(static_cast<void*>(data_ + pos_index + 1), static_cast<const void*>(data_ + pos_index),
+                             tail * sizeof(T));
+            }
         } else {
-            std::uninitialized_copy_n(data_.GetAddress(), size_, new_buffer.GetAddress());
+            RawMemory<T, Alloc, Ownership> new_buffer(data_.GetAllocator());
+            try {
+                AllocateBuffer(new_capacity, data_.GetAllocator()).Swap(new_buffer);
+            } catch (...) {
+                element->~T();
+                throw;
+            }
+            if (tail != 0) {
+                detail::RelocateWithGap(data_.GetAddress(), size_, pos_index, new_buffer.GetAddress());
+            } else {
+                detail::RelocateN(data_.GetAddress(), size_, new_buffer.GetAddress());
+            }
+            NoteReallocation(size_);
+            data_.Swap(new_buffer);
         }
-
-        std::destroy_n(data_.GetAddress(), size_);
-        data_.Swap(new_buffer);
+        std::memcpy(static_cast<void*>(data_ + pos_index), static_cast<const void*>(element), sizeof(T));
+        return true;
     } else {
-        new (data_ + size_) T(std::move(value));
+        return false;
     }
-    ++size_;
 }
 
-template<typename T>
-void Vector<T>::PopBack() noexcept {
-    data_[--size_].~T();
+template<typename T, typename Alloc, typename Growth, typename Stats, typename Ownership>
+template<typename... Args>
+T& Vector<T, Alloc, Growth, Stats, Ownership>::EmplaceBack(Args&&... args) {
+    if (size_ == Capacity()) {
+        return *EmplaceWithReallocation(size_, std::forward<Args>(args)...);
+    }
+    new (data_ + size_) T (std::forward<Args>(args)...);
+    ++size_;
+
+    return data_[size_-1];
 }
 
-template<typename T>
+template<typename T, typename Alloc, typename Growth, typename Stats, typename Ownership>
 template<typename... Args>
-T& Vector<T>::EmplaceBack(Args&&... args) {
+typename Vector<T, Alloc, Growth, Stats, Ownership>::iterator Vector<T, Alloc, Growth, Stats, Ownership>::Emplace(typename Vector<T, Alloc, Growth, Stats, Ownership>::const_iterator pos, Args &&... args) {
+    const size_t pos_index = PositionIndex(pos);
+
     if (size_ == Capacity()) {
-        RawMemory<T> new_buffer(size_ == 0 ? 1 : size_ * 2);
-        new (new_buffer + size_) T (std::forward<Args>(args)...);
+        return EmplaceWithReallocation(pos_index, std::forward<Args>(args)...);
+    }
 
-        if constexpr (std::is_nothrow_move_constructible_v<T> || !std::is_copy_constructible_v<T>) {
-            std::uninitialized_move_n(data_.GetAddress(), size_, new_buffer.GetAddress());
-        } else {
-            std::uninitialized_copy_n(data_.GetAddress(), size_, new_buffer.GetAddress());
+    T* result = detail::EmplaceInPlace(data_.GetAddress(), size_, pos_index, std::forward<Args>(args)...);
+    ++size_;
+    return MakeIterator(result);
+}
+
+template<typename T, typename Alloc, typename Growth, typename Stats, typename Ownership>
+typename Vector<T, Alloc, Growth, Stats, Ownership>::iterator Vector<T, Alloc, Growth, Stats, Ownership>::Insert(typename Vector<T, Alloc, Growth, Stats, Ownership>::const_iterator pos, const T &value) {
+    return Emplace(pos, value);
+}
+
+template<typename T, typename Alloc, typename Growth, typename Stats, typename Ownership>
+typename Vector<T, Alloc, Growth, Stats, Ownership>::iterator Vector<T, Alloc, Growth, Stats, Ownership>::Insert(typename Vector<T, Alloc, Growth, Stats, Ownership>::const_iterator pos, T&& value) {
+    return Emplace(pos, std::move(value));
+}
+
+template<typename T, typename Alloc, typename Growth, typename Stats, typename Ownership>
+typename Vector<T, Alloc, Growth, Stats, Ownership>::iterator Vector<T, Alloc, Growth, Stats, Ownership>::Erase(typename Vector<T, Alloc, Growth, Stats, Ownership>::const_iterator pos) noexcept(kNothrowErase) {
+    const size_t pos_index = PositionIndex(pos);
+    VECTOR_CHECK(pos_index < size_);
+
+    T* result = detail::EraseAt(data_.GetAddress(), size_, pos_index);
+    --size_;
+    InvalidateIterators();
+    return MakeIterator(result);
+}
+
+template<typename T, typename Alloc, typename Growth, typename Stats, typename Ownership>
+template<typename InputIt, typename>
+void Vector<T, Alloc, Growth, Stats, Ownership>::Append(InputIt first, InputIt last) {
+    using Category = typename std::iterator_traits<InputIt>::iterator_category;
+    if constexpr (std::is_convertible_v<Category, std::forward_iterator_tag>) {
+        InsertRange(size_, first, static_cast<size_t>(std::distance(first, last)));
+    } else {
+        for (; first != last; ++first) {
+            EmplaceBack(*first);
         }
+    }
+}
+
+template<typename T, typename Alloc, typename Growth, typename Stats, typename Ownership>
+template<typename InputIt, typename>
+typename Vector<T, Alloc, Growth, Stats, Ownership>::iterator Vector<T, Alloc, Growth, Stats, Ownership>::Insert(const_iterator pos,
+                                                                             InputIt first, InputIt last) {
+    const size_t pos_index = PositionIndex(pos);
+    using Category = typename std::iterator_traits<InputIt>::iterator_category;
+    if constexpr (std::is_convertible_v<Category, std::forward_iterator_tag>) {
+        return InsertRange(pos_index, first, static_cast<size_t>(std::distance(first, last)));
+    } else {
+        // Длина однопроходного диапазона неизвестна: дописываем в конец и переставляем на место
+        const size_t old_size = size_;
+        Append(first, last);
+        std::rotate(begin() + pos_index, begin() + old_size, end());
+        return begin() + pos_index;
+    }
+}
+
+template<typename T, typename Alloc, typename Growth, typename Stats, typename Ownership>
+typename Vector<T, Alloc, Growth, Stats, Ownership>::iterator Vector<T, Alloc, Growth, Stats, Ownership>::Insert(const_iterator pos,
+                                                                             size_t count, const T& value) {
+    const size_t pos_index = PositionIndex(pos);
+    if (size_ + count <= Capacity() && !std::less<const T*>()(&value, Data())
+        && std::less<const T*>()(&value, Data() + size_)) {
+        // Значение лежит в самом векторе и сдвинется вместе с хвостом
+        const T value_copy(value);
+        return InsertRange(pos_index, detail::RepeatIterator<T>(&value_copy, 0), count);
+    }
+    return InsertRange(pos_index, detail::RepeatIterator<T>(&value, 0), count);
+}
 
-        std::destroy_n(data_.GetAddress(), size_);
+template<typename T, typename Alloc, typename Growth, typename Stats, typename Ownership>
+typename Vector<T, Alloc, Growth, Stats, Ownership>::iterator Vector<T, Alloc, Growth, Stats, Ownership>::Insert(const_iterator pos,
+                                                                             std::initializer_list<T> values) {
+    return InsertRange(PositionIndex(pos), values.begin(), values.size());
+}
+
+template<typename T, typename Alloc, typename Growth, typename Stats, typename Ownership>
+template<typename ForwardIt>
+typename Vector<T, Alloc, Growth, Stats, Ownership>::iterator Vector<T, Alloc, Growth, Stats, Ownership>::InsertRange(size_t pos_index,
+                                                                                  ForwardIt first, size_t count) {
+    if (count == 0) {
+        return begin() + pos_index;
+    }
+
+    if (size_ + count > Capacity()) {
+        RawMemory<T, Alloc, Ownership> new_buffer = AllocateBuffer(Growth::NextCapacity(Capacity(), size_ + count, sizeof(T)),
+                                                        data_.GetAllocator());
+        detail::CopyConstructN(first, count, new_buffer + pos_index);
+        try {
+            detail::RelocateWithGap(data_.GetAddress(), size_, pos_index, new_buffer.GetAddress(), count);
+        } catch (...) {
+            std::destroy_n(new_buffer + pos_index, count);
+            throw;
+        }
+        NoteReallocation(size_);
         data_.Swap(new_buffer);
+        size_ += count;
+        return begin() + pos_index;
+    }
+
+    T* current_pos = data_ + pos_index;
+    T* old_end = data_ + size_;
+    const size_t elems_after = size_ - pos_index;
+
+    if constexpr (IsTriviallyRelocatableV<T>) {
+        std::memmove(static_cast<void*>(current_pos + count), static_cast<const void*>(current_pos),
+                     elems_after * sizeof(T));
+        try {
+            detail::CopyConstructN(first, count, current_pos);
+        } catch (...) {
+            std::memmove(static_cast<void*>(current_pos), static_cast<const void*>(current_pos + count),
+                         elems_after * sizeof(T));
+            throw;
+        }
+        size_ += count;
+    } else if (elems_after > count) {
+        std::uninitialized_move(old_end - count, old_end, old_end);
+        size_ += count;
+        std::move_backward(current_pos, old_end - count, old_end);
+        std::copy_n(first, count, current_pos);
     } else {
-        new (data_ + size_) T (std::forward<Args>(args)...);
+        ForwardIt mid = std::next(first, elems_after);
+        detail::CopyConstructN(mid, count - elems_after, old_end);
+        try {
+            std::uninitialized_move(current_pos, old_end, current_pos + count);
+        } catch (...) {
+            std::destroy_n(old_end, count - elems_after);
+            throw;
+        }
+        size_ += count;
+        std::copy(first, mid, current_pos);
     }
-    ++size_;
+    return MakeIterator(current_pos);
+}
 
-    return data_[size_-1];
+template<typename T, typename Alloc, typename Growth, typename Stats, typename Ownership>
+typename Vector<T, Alloc, Growth, Stats, Ownership>::iterator Vector<T, Alloc, Growth, Stats, Ownership>::Erase(const_iterator first,
+                                                                            const_iterator last) noexcept(kNothrowErase) {
+    const size_t first_index = PositionIndex(first);
+    const size_t last_index = PositionIndex(last);
+    VECTOR_CHECK(first_index <= last_index);
+
+    T* result = detail::EraseRange(data_.GetAddress(), size_, first_index, last_index);
+    size_ -= last_index - first_index;
+    if (first_index != last_index) {
+        InvalidateIterators();
+    }
+    return MakeIterator(result);
 }
 
-template<typename T>
-template<typename... Args>
-typename Vector<T>::iterator Vector<T>::Emplace(typename Vector<T>::const_iterator pos, Args &&... args) {
-    assert((pos - begin()) <= static_cast<int>(size_));
-    assert((end() - pos) <= static_cast<int>(size_));
+template<typename T, typename Alloc, typename Growth, typename Stats, typename Ownership>
+template<typename Predicate>
+size_t Vector<T, Alloc, Growth, Stats, Ownership>::EraseIf(Predicate pred) {
+    const size_t old_size = size_;
+    detail::EraseIf(data_.GetAddress(), size_, pred);
+    if (size_ != old_size) {
+        InvalidateIterators();
+    }
+    return old_size - size_;
+}
 
-    size_t pos_index = pos - begin();
-    iterator current_pos = begin() + pos_index;
-    iterator result = current_pos;
+template<typename T, typename Alloc, typename Growth, typename Stats, typename Ownership>
+typename Vector<T, Alloc, Growth, Stats, Ownership>::iterator Vector<T, Alloc, Growth, Stats, Ownership>::EraseUnordered(const_iterator pos) noexcept(kNothrowErase) {
+    VECTOR_CHECK(PositionIndex(pos) < size_);
 
-    if (size_ == Capacity()) {
+    return EraseUnordered(pos, pos + 1);
+}
 
-        RawMemory<T> new_buffer(size_ == 0 ? 1 : size_ * 2);
-        iterator new_pos = new_buffer + pos_index;
-        new (new_pos) T (std::forward<Args>(args)...);
+template<typename T, typename Alloc, typename Growth, typename Stats, typename Ownership>
+typename Vector<T, Alloc, Growth, Stats, Ownership>::iterator Vector<T, Alloc, Growth, Stats, Ownership>::EraseUnordered(const_iterator first,
+                                                                                     const_iterator last) noexcept(kNothrowErase) {
+    const size_t first_index = PositionIndex(first);
+    const size_t last_index = PositionIndex(last);
+    VECTOR_CHECK(first_index <= last_index);
+
+    T* result = detail::EraseUnorderedRange(data_.GetAddress(), size_, first_index, last_index);
+    size_ -= last_index - first_index;
+    if (first_index != last_index) {
+        InvalidateIterators();
+    }
+    return MakeIterator(result);
+}
 
-        if constexpr (std::is_nothrow_move_constructible_v<T> || !std::is_copy_constructible_v<T>) {
-            std::uninitialized_move_n(data_.GetAddress(), pos_index, new_buffer.GetAddress());
-            std::uninitialized_move_n(data_ + pos_index, size_ - pos_index, new_pos + 1);
+template<typename T, typename Alloc, typename Growth, typename Stats, typename Ownership>
+template<typename Predicate>
+size_t Vector<T, Alloc, Growth, Stats, Ownership>::EraseUnorderedIf(Predicate pred) {
+    const size_t old_size = size_;
+    for (size_t i = 0; i < size_;) {
+        if (pred(std::as_const(data_[i]))) {
+            detail::EraseUnorderedRange(data_.GetAddress(), size_, i, i + 1);
+            --size_;
         } else {
-            std::uninitialized_copy_n(data_.GetAddress(), pos_index, new_buffer.GetAddress());
-            std::uninitialized_copy_n(data_ + pos_index, size_ - pos_index, new_pos + 1);
+            ++i;
         }
+    }
+    if (size_ != old_size) {
+        InvalidateIterators();
+    }
+    return old_size - size_;
+}
 
-        std::destroy_n(data_.GetAddress(), size_);
-        data_.Swap(new_buffer);
+template<typename T, typename Alloc, typename Growth, typename Stats, typename Ownership>
+RawMemory<T, Alloc, Ownership> Vector<T, Alloc, Growth, Stats, Ownership>::AllocateBuffer(size_t capacity, const Alloc& alloc) {
+    RawMemory<T, Alloc, Ownership> buffer(capacity, alloc);
+    if (capacity != 0) {
+        Stats::OnAllocate(capacity * sizeof(T));
+    }
+    return buffer;
+}
 
-        result = new_pos;
-    } else if (current_pos == end()) {
-        new (current_pos) T (std::forward<Args>(args)...);
-    } else{
-        T temp_el(std::forward<Args>(args)...);
-        new (end()) T (std::forward<T>(*(end() - 1)));
-        std::move_backward(current_pos, end() - 1, end());
-//        new (current_pos) T (std::forward<T>(temp_el));
-        *current_pos = std::move(temp_el);
+template<typename T, typename Alloc, typename Growth, typename Stats, typename Ownership>
+void Vector<T, Alloc, Growth, Stats, Ownership>::NoteRelease(const RawMemory<T, Alloc, Ownership>& buffer, size_t size) noexcept {
+    if (buffer.Capacity() != 0) {
+        Stats::OnRelease(buffer.Capacity() * sizeof(T), size * sizeof(T));
     }
+}
 
-    ++size_;
-    return result;
+// Вызывается до замены буфера: рост пустого вектора переносом не считается
+template<typename T, typename Alloc, typename Growth, typename Stats, typename Ownership>
+void Vector<T, Alloc, Growth, Stats, Ownership>::NoteReallocation(size_t relocated_elements) const noexcept {
+    if (data_.Capacity() != 0) {
+        Stats::OnReallocate(relocated_elements);
+    }
 }
 
-template<typename T>
-typename Vector<T>::iterator Vector<T>::Insert(typename Vector<T>::const_iterator pos, const T &value) {
-    return Emplace(pos, value);
+template<typename T, typename Alloc, typename Growth, typename Stats, typename Ownership>
+void Vector<T, Alloc, Growth, Stats, Ownership>::Clear() noexcept {
+    detail::DestroyN(data_.GetAddress(), size_);
+    size_ = 0;
+    InvalidateIterators();
 }
 
-template<typename T>
-typename Vector<T>::iterator Vector<T>::Insert(typename Vector<T>::const_iterator pos, T&& value) {
-    return Emplace(pos, std::move(value));
+template<typename T, typename Alloc, typename Growth, typename Stats, typename Ownership>
+void Vector<T, Alloc, Growth, Stats, Ownership>::ShrinkToFit() {
+    if (size_ == data_.Capacity()) {
+        return;
+    }
+    if (size_ == 0) {
+        ReleaseBuffer();
+        return;
+    }
+
+    if constexpr (IsTriviallyRelocatableV<T>) {
+        if (data_.TryShrink(size_)) {
+            NoteReallocation(0);
+            return;
+        }
+    }
+
+    RawMemory<T, Alloc, Ownership> new_buffer = AllocateBuffer(size_, data_.GetAllocator());
+    detail::RelocateN(data_.GetAddress(), size_, new_buffer.GetAddress());
+    NoteReallocation(size_);
+    data_.Swap(new_buffer);
 }
 
-template<typename T>
-typename Vector<T>::iterator Vector<T>::Erase(typename Vector<T>::const_iterator pos) {
-    assert((pos - begin()) <= static_cast<int>(size_));
-    assert((end() - pos) <= static_cast<int>(size_));
-    assert(pos != end());
-    assert(size_ != 0);
+template<typename T, typename Alloc, typename Growth, typename Stats, typename Ownership>
+RawMemory<T, Alloc, Ownership> Vector<T, Alloc, Growth, Stats, Ownership>::ReleaseBuffer() noexcept {
+    NoteRelease(data_, size_);
+    Clear();
+    RawMemory<T, Alloc, Ownership> buffer(data_.GetAllocator());
+    buffer.Swap(data_);
+    return buffer;
+}
 
-    size_t pos_index = pos - begin();
-    iterator current_pos = begin() + pos_index;
-    current_pos->~T();
-    std::move(current_pos + 1, end(), current_pos);
-    iterator result = data_ + pos_index;
-    --size_;
-    return result;
+template<typename T, typename Alloc, typename Growth, typename Stats, typename Ownership>
+void Vector<T, Alloc, Growth, Stats, Ownership>::AdoptBuffer(RawMemory<T, Alloc, Ownership>&& buffer, size_t size) noexcept {
+    VECTOR_CHECK(size <= buffer.Capacity());
+    RawMemory<T, Alloc, Ownership> adopted(std::move(buffer));
+    NoteRelease(data_, size_);
+    Clear();
+    data_.Swap(adopted);
+    size_ = size;
+}
+
+template<typename T, typename Alloc, typename Growth, typename Stats, typename Ownership>
+void Vector<T, Alloc, Growth, Stats, Ownership>::Adopt(T* data, size_t size, size_t capacity, BufferDeleter<T> deleter) {
+    VECTOR_CHECK(size <= capacity);
+    // При исключении буфер уже возвращён deleter, а текущие элементы вектора не тронуты
+    RawMemory<T, Alloc, Ownership> adopted(data_.GetAllocator());
+    adopted.Adopt(data, capacity, std::move(deleter));
+    NoteRelease(data_, size_);
+    Clear();
+    data_.Swap(adopted);
+    size_ = size;
+}
+
+template<typename T, typename Alloc, typename Growth, typename Stats, typename Ownership>
+void Vector<T, Alloc, Growth, Stats, Ownership>::Adopt(ExternalBuffer<T>&& buffer) {
+    Adopt(std::exchange(buffer.data, nullptr), std::exchange(buffer.size, 0), std::exchange(buffer.capacity, 0),
+          std::move(buffer.deleter));
+}
+
+template<typename T, typename Alloc, typename Growth, typename Stats, typename Ownership>
+ExternalBuffer<T> Vector<T, Alloc, Growth, Stats, Ownership>::Release() {
+    NoteRelease(data_, size_);
+    ExternalBuffer<T> released = data_.Release();
+    released.size = std::exchange(size_, 0);
+    return released;
+}
+
+template<typename T, typename Alloc, typename Growth, typename Stats, typename Ownership>
+template<typename Fn>
+void Vector<T, Alloc, Growth, Stats, Ownership>::WithScratch(Fn fn) {
+    if (data_.Capacity() - size_ >= size_) {
+        fn(data_ + size_);
+        return;
+    }
+    RawMemory<T, Alloc, Ownership> scratch = AllocateBuffer(size_, data_.GetAllocator());
+    fn(scratch.GetAddress());
+}
+
+template<typename T, typename Alloc, typename Growth, typename Stats, typename Ownership>
+template<typename Compare>
+void Vector<T, Alloc, Growth, Stats, Ownership>::Sort(Compare comp) {
+    Sort(ParallelPolicy{1}, comp);
+}
+
+template<typename T, typename Alloc, typename Growth, typename Stats, typename Ownership>
+template<typename Compare>
+void Vector<T, Alloc, Growth, Stats, Ownership>::Sort(const ParallelPolicy& policy, Compare comp) {
+    const size_t threads = policy.ChunkCount(size_);
+    bool needs_scratch = threads > 1;
+    if constexpr (detail::kRadixSortable<T> && detail::kIsDefaultLess<Compare, T>) {
+        needs_scratch = needs_scratch || size_ >= detail::kRadixSortThreshold;
+    }
+    if (!needs_scratch) {
+        std::sort(begin(), end(), comp);
+        return;
+    }
+    WithScratch([&](T* scratch) {
+        detail::Sort(data_.GetAddress(), size_, scratch, comp, threads);
+    });
+}
+
+template<typename T, typename Alloc, typename Growth, typename Stats, typename Ownership>
+template<typename Compare>
+void Vector<T, Alloc, Growth, Stats, Ownership>::StableSort(Compare comp) {
+    StableSort(ParallelPolicy{1}, comp);
+}
+
+template<typename T, typename Alloc, typename Growth, typename Stats, typename Ownership>
+template<typename Compare>
+void Vector<T, Alloc, Growth, Stats, Ownership>::StableSort(const ParallelPolicy& policy, Compare comp) {
+    const size_t threads = policy.ChunkCount(size_);
+    if (size_ <= detail::kInsertionSortRun) {
+        detail::InsertionSort(data_.GetAddress(), size_, comp);
+        return;
+    }
+    WithScratch([&](T* scratch) {
+        detail::StableSort(data_.GetAddress(), size_, scratch, comp, threads);
+    });
+}
+
+template<typename T, typename Alloc, typename Growth, typename Stats, typename Ownership>
+template<typename Predicate>
+typename Vector<T, Alloc, Growth, Stats, Ownership>::iterator Vector<T, Alloc, Growth, Stats, Ownership>::Partition(Predicate pred) {
+    return std::partition(begin(), end(), pred);
+}
+
+template<typename T, typename Alloc, typename Growth, typename Stats, typename Ownership>
+template<typename Compare>
+void Vector<T, Alloc, Growth, Stats, Ownership>::NthElement(size_t n, Compare comp) {
+    VECTOR_CHECK(n < size_);
+    std::nth_element(begin(), begin() + n, end(), comp);
+}
+
+template<typename T, typename Alloc, typename Growth, typename Stats, typename Ownership>
+void Vector<T, Alloc, Growth, Stats, Ownership>::Fill(const T& value) noexcept(std::is_nothrow_copy_assignable_v<T>) {
+    if constexpr (simd::kSupported<T>) {
+        simd::Fill(data_.GetAddress(), size_, value);
+    } else {
+        std::fill_n(data_.GetAddress(), size_, value);
+    }
+}
+
+template<typename T, typename Alloc, typename Growth, typename Stats, typename Ownership>
+typename Vector<T, Alloc, Growth, Stats, Ownership>::iterator Vector<T, Alloc, Growth, Stats, Ownership>::Find(const T& value) noexcept(detail::kNothrowEqual<T>) {
+    if constexpr (simd::kSupported<T>) {
+        return begin() + simd::Find(data_.GetAddress(), size_, value);
+    } else {
+        return std::find(begin(), end(), value);
+    }
+}
+
+template<typename T, typename Alloc, typename Growth, typename Stats, typename Ownership>
+typename Vector<T, Alloc, Growth, Stats, Ownership>::const_iterator Vector<T, Alloc, Growth, Stats, Ownership>::Find(const T& value) const noexcept(detail::kNothrowEqual<T>) {
+    return const_cast<Vector&>(*this).Find(value);
+}
+
+template<typename T, typename Alloc, typename Growth, typename Stats, typename Ownership>
+size_t Vector<T, Alloc, Growth, Stats, Ownership>::Count(const T& value) const noexcept(detail::kNothrowEqual<T>) {
+    if constexpr (simd::kSupported<T>) {
+        return simd::Count(data_.GetAddress(), size_, value);
+    } else {
+        return static_cast<size_t>(std::count(cbegin(), cend(), value));
+    }
+}
+
+template<typename T, typename Alloc, typename Growth, typename Stats, typename Ownership>
+simd::SumType<T> Vector<T, Alloc, Growth, Stats, Ownership>::Sum() const noexcept {
+    return simd::Sum(data_.GetAddress(), size_);
+}
+
+template<typename T, typename Alloc, typename Growth, typename Stats, typename Ownership>
+std::pair<T, T> Vector<T, Alloc, Growth, Stats, Ownership>::MinMax() const noexcept {
+    VECTOR_CHECK(size_ != 0);
+    return simd::MinMax(data_.GetAddress(), size_);
+}
+
+template<typename T, typename Alloc, typename Growth, typename Stats, typename Ownership>
+template<typename UnaryOp>
+void Vector<T, Alloc, Growth, Stats, Ownership>::Transform(UnaryOp op) {
+    simd::Transform(data_.GetAddress(), size_, std::move(op));
+}
+
+// Для арифметических T сравнение идёт блоками через simd::Equal, для остальных — через operator== элементов
+template<typename T, typename Alloc, typename Growth, typename Stats, typename Ownership>
+bool operator==(const Vector<T, Alloc, Growth, Stats, Ownership>& lhs, const Vector<T, Alloc, Growth, Stats, Ownership>& rhs) {
+    if (lhs.Size() != rhs.Size()) {
+        return false;
+    }
+    if constexpr (simd::kSupported<T>) {
+        return simd::Equal(lhs.Data(), rhs.Data(), lhs.Size());
+    } else {
+        return std::equal(lhs.cbegin(), lhs.cend(), rhs.cbegin());
+    }
+}
+
+template<typename T, typename Alloc, typename Growth, typename Stats, typename Ownership>
+bool operator!=(const Vector<T, Alloc, Growth, Stats, Ownership>& lhs, const Vector<T, Alloc, Growth, Stats, Ownership>& rhs) {
+    return !(lhs == rhs);
+}
+
+template<typename T, typename Alloc, typename Growth, typename Stats, typename Ownership>
+Vector<T, Alloc, Growth, Stats, Ownership>::Vector(size_t size, const ParallelPolicy& policy, const Alloc& alloc)
+        : data_(AllocateBuffer(size, alloc)) {
+    T* data = data_.GetAddress();
+    detail::ParallelConstruct(data, size, policy, [data](size_t offset, size_t n) {
+        detail::ValueConstructN(data + offset, n);
+    });
+    size_ = size;
+}
+
+template<typename T, typename Alloc, typename Growth, typename Stats, typename Ownership>
+Vector<T, Alloc, Growth, Stats, Ownership>::Vector(size_t size, const T& value, const ParallelPolicy& policy, const Alloc& alloc)
+        : data_(AllocateBuffer(size, alloc)) {
+    T* data = data_.GetAddress();
+    detail::ParallelConstruct(data, size, policy, [data, &value](size_t offset, size_t n) {
+        detail::FillConstructN(data + offset, n, value);
+    });
+    size_ = size;
+}
+
+template<typename T, typename Alloc, typename Growth, typename Stats, typename Ownership>
+Vector<T, Alloc, Growth, Stats, Ownership>::Vector(const Vector& other, const ParallelPolicy& policy)
+        : data_(AllocateBuffer(other.size_,
+                               AllocTraits::select_on_container_copy_construction(other.data_.GetAllocator()))) {
+    T* data = data_.GetAddress();
+    const T* source = other.data_.GetAddress();
+    detail::ParallelConstruct(data, other.size_, policy, [data, source](size_t offset, size_t n) {
+        detail::CopyConstructN(source + offset, n, data + offset);
+    });
+    size_ = other.size_;
+}
+
+template<typename T, typename Alloc, typename Growth, typename Stats, typename Ownership>
+void Vector<T, Alloc, Growth, Stats, Ownership>::Resize(size_t new_size, const ParallelPolicy& policy) {
+    if (new_size < size_) {
+        detail::ParallelDestroy(data_ + new_size, size_ - new_size, policy);
+        InvalidateIterators();
+    } else if (new_size > size_) {
+        Reserve(new_size);
+        T* tail = data_ + size_;
+        detail::ParallelConstruct(tail, new_size - size_, policy, [tail](size_t offset, size_t n) {
+            detail::ValueConstructN(tail + offset, n);
+        });
+    }
+    size_ = new_size;
+}
+
+template<typename T, typename Alloc, typename Growth, typename Stats, typename Ownership>
+void Vector<T, Alloc, Growth, Stats, Ownership>::Clear(const ParallelPolicy& policy) noexcept {
+    detail::ParallelDestroy(data_.GetAddress(), size_, policy);
+    size_ = 0;
+    InvalidateIterators();
 }
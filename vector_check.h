@@ -0,0 +1,187 @@
+#pragma once
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <functional>
+#include <iterator>
+#include <type_traits>
+
+// Уровень проверок контейнеров, задаётся до подключения заголовков:
+//   0 — проверок нет совсем, даже в отладочной сборке;
+//   1 — границы индексов и позиций в operator[], Emplace, Insert, Erase и т.п., независимо от NDEBUG;
+//   2 — вдобавок итераторы Vector помнят, из какого буфера они получены, и обращение через итератор,
+//       пережившее перевыделение, Swap или перенос вектора, аварийно завершает программу. Операции,
+//       уменьшающие размер (Erase, PopBack, Clear, сжимающий Resize), считаются сменой буфера: после
+//       них недействительны все итераторы вектора, а не только стоящие за точкой удаления.
+// По умолчанию 1 в отладочной сборке и 0 с NDEBUG, как у прежних assert. При нарушении проверки
+// сообщение пишется в stderr и вызывается std::abort
+#ifndef VECTOR_CHECK_LEVEL
+#ifdef NDEBUG
+#define VECTOR_CHECK_LEVEL 0
+#else
+#define VECTOR_CHECK_LEVEL 1
+#endif
+#endif
+
+#if VECTOR_CHECK_LEVEL >= 1
+#define VECTOR_CHECK(condition) \
+    ((condition) ? static_cast<void>(0) : ::detail::CheckFailed(#condition, __FILE__, __LINE__))
+#else
+#define VECTOR_CHECK(condition) static_cast<void>(0)
+#endif
+
+namespace detail {
+
+    [[noreturn]] inline void CheckFailed(const char* condition, const char* file, int line) noexcept {
+        std::fprintf(stderr, "%s:%d: vector check failed: %s\n", file, line, condition);
+        std::abort();
+    }
+
+    // Указатель лежит в [first, last]; сравнение через std::less, поскольку указатели могут быть из разных массивов
+    template <typename T>
+    bool PointerInRange(const T* pointer, const T* first, const T* last) noexcept {
+        return !std::less<const T*>()(pointer, first) && !std::less<const T*>()(last, pointer);
+    }
+
+#if VECTOR_CHECK_LEVEL >= 2
+    // Номер буфера, уникальный на всё время работы программы; 0 означает отсутствие буфера
+    inline uint64_t NextBufferGeneration() noexcept {
+        static std::atomic<uint64_t> counter{0};
+        return counter.fetch_add(1, std::memory_order_relaxed) + 1;
+    }
+
+    // Итератор непрерывного контейнера, запоминающий контейнер и номер его буфера. Разыменование и
+    // приведение к указателю (Base) проверяют, что буфер тот же и позиция внутри [begin, end).
+    // Контейнер Owner предоставляет IsValidIterator(pointer, generation, dereferenceable) и
+    // BufferGeneration(). Итератор не переживает сам контейнер: после его разрушения проверка не работает
+    template <typename Owner, typename Value>
+    class CheckedIterator {
+    public:
+        using iterator_category = std::random_access_iterator_tag;
+        using value_type = std::remove_cv_t<Value>;
+        using difference_type = std::ptrdiff_t;
+        using reference = Value&;
+        using pointer = Value*;
+
+        CheckedIterator() = default;
+
+        CheckedIterator(Value* pointer, const Owner* owner) noexcept
+                : pointer_(pointer), owner_(owner), generation_(owner->BufferGeneration()) {
+        }
+
+        // Неконстантный итератор приводится к константному
+        template <typename OtherValue,
+                  typename = std::enable_if_t<std::is_same_v<const OtherValue, Value> && !std::is_same_v<OtherValue, Value>>>
+        CheckedIterator(const CheckedIterator<Owner, OtherValue>& other) noexcept  // NOLINT(google-explicit-constructor)
+                : pointer_(other.pointer_), owner_(other.owner_), generation_(other.generation_) {
+        }
+
+        // Указатель на элемент; итератор end() тоже допустим
+        Value* Base() const noexcept {
+            Validate(false);
+            return pointer_;
+        }
+
+        reference operator*() const noexcept {
+            Validate(true);
+            return *pointer_;
+        }
+
+        pointer operator->() const noexcept {
+            Validate(true);
+            return pointer_;
+        }
+
+        reference operator[](difference_type n) const noexcept {
+            return *(*this + n);
+        }
+
+        CheckedIterator& operator++() noexcept {
+            ++pointer_;
+            return *this;
+        }
+
+        CheckedIterator operator++(int) noexcept {
+            CheckedIterator old = *this;
+            ++pointer_;
+            return old;
+        }
+
+        CheckedIterator& operator--() noexcept {
+            --pointer_;
+            return *this;
+        }
+
+        CheckedIterator operator--(int) noexcept {
+            CheckedIterator old = *this;
+            --pointer_;
+            return old;
+        }
+
+        CheckedIterator& operator+=(difference_type n) noexcept {
+            pointer_ += n;
+            return *this;
+        }
+
+        CheckedIterator& operator-=(difference_type n) noexcept {
+            pointer_ -= n;
+            return *this;
+        }
+
+        friend CheckedIterator operator+(CheckedIterator it, difference_type n) noexcept {
+            return it += n;
+        }
+
+        friend CheckedIterator operator+(difference_type n, CheckedIterator it) noexcept {
+            return it += n;
+        }
+
+        friend CheckedIterator operator-(CheckedIterator it, difference_type n) noexcept {
+            return it -= n;
+        }
+
+        friend difference_type operator-(const CheckedIterator& lhs, const CheckedIterator& rhs) noexcept {
+            return lhs.pointer_ - rhs.pointer_;
+        }
+
+        friend bool operator==(const CheckedIterator& lhs, const CheckedIterator& rhs) noexcept {
+            return lhs.pointer_ == rhs.pointer_;
+        }
+
+        friend bool operator!=(const CheckedIterator& lhs, const CheckedIterator& rhs) noexcept {
+            return lhs.pointer_ != rhs.pointer_;
+        }
+
+        friend bool operator<(const CheckedIterator& lhs, const CheckedIterator& rhs) noexcept {
+            return lhs.pointer_ < rhs.pointer_;
+        }
+
+        friend bool operator<=(const CheckedIterator& lhs, const CheckedIterator& rhs) noexcept {
+            return lhs.pointer_ <= rhs.pointer_;
+        }
+
+        friend bool operator>(const CheckedIterator& lhs, const CheckedIterator& rhs) noexcept {
+            return lhs.pointer_ > rhs.pointer_;
+        }
+
+        friend bool operator>=(const CheckedIterator& lhs, const CheckedIterator& rhs) noexcept {
+            return lhs.pointer_ >= rhs.pointer_;
+        }
+
+    private:
+        template <typename, typename>
+        friend class CheckedIterator;
+
+        void Validate(bool dereferenceable) const noexcept {
+            VECTOR_CHECK(owner_ != nullptr && owner_->IsValidIterator(pointer_, generation_, dereferenceable));
+        }
+
+        Value* pointer_ = nullptr;
+        const Owner* owner_ = nullptr;
+        uint64_t generation_ = 0;
+    };
+#endif
+
+}  // namespace detail
@@ -0,0 +1,347 @@
+#pragma once
+#include "vector.h"
+#include "vector_check.h"
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <istream>
+#include <limits>
+#include <ostream>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include <utility>
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#define VECTOR_IO_MMAP 1
+#endif
+
+// Двоичный формат векторов тривиально копируемых типов: заголовок VectorFileHeader, дополненный нулями
+// до kVectorFileDataOffset байт, затем байты элементов как есть. Смещение данных кратно строке кэша,
+// поэтому отображённые в память элементы выровнены. Порядок байт — родной для машины, он записан
+// в заголовок и проверяется при чтении
+struct VectorFileHeader {
+    static constexpr char kMagic[4] = {'V', 'E', 'C', 'T'};
+    static constexpr uint32_t kVersion = 1;
+    static constexpr uint32_t kByteOrderMark = 0x01020304;
+
+    char magic[4] = {kMagic[0], kMagic[1], kMagic[2], kMagic[3]};
+    uint32_t version = kVersion;
+    uint32_t byte_order = kByteOrderMark;
+    uint32_t element_size = 0;
+    uint32_t element_alignment = 0;
+    uint32_t data_offset = 0;
+    uint64_t count = 0;
+
+    template <typename T>
+    static VectorFileHeader For(uint64_t count) noexcept;
+
+    // Бросает std::runtime_error, если файл записан не для T или не этой версией формата
+    template <typename T>
+    void Validate() const;
+};
+
+inline constexpr size_t kVectorFileDataOffset = kCacheLineSize;
+static_assert(sizeof(VectorFileHeader) <= kVectorFileDataOffset);
+
+// Потоковая запись: элементы дописываются по мере появления, число элементов в заголовке
+// исправляется в Finish, поэтому поток должен поддерживать seekp
+template <typename T>
+class VectorWriter {
+    static_assert(std::is_trivially_copyable_v<T>, "only trivially copyable types are stored as raw bytes");
+
+public:
+    explicit VectorWriter(std::ostream& out);
+
+    void Write(const T* values, size_t count);
+
+    void Write(const T& value) {
+        Write(&value, 1);
+    }
+
+    // Записывает итоговое число элементов в заголовок
+    void Finish();
+
+    size_t Count() const noexcept {
+        return count_;
+    }
+
+private:
+    std::ostream& out_;
+    std::ostream::pos_type header_pos_;
+    size_t count_ = 0;
+};
+
+template <typename T, typename Alloc, typename Growth, typename Stats, typename Ownership>
+void WriteVector(std::ostream& out, const Vector<T, Alloc, Growth, Stats, Ownership>& values);
+
+// Читает вектор без предварительного заполнения нулями: байты читаются прямо в выделенный буфер
+template <typename T>
+Vector<T> ReadVector(std::istream& in);
+
+// Неизменяемый вектор поверх файла. Там, где есть mmap, файл отображается в память целиком, и элементы
+// доступны сразу без копирования и конструирования; страницы подгружаются ядром по обращению.
+// На остальных системах файл читается в буфер RawMemory
+template <typename T>
+class VectorView {
+    static_assert(std::is_trivially_copyable_v<T>, "only trivially copyable types are stored as raw bytes");
+
+public:
+    using const_iterator = const T*;
+    using iterator = const_iterator;
+
+    VectorView() = default;
+    VectorView(const VectorView&) = delete;
+    VectorView(VectorView&& other) noexcept;
+    ~VectorView();
+
+    VectorView& operator=(const VectorView&) = delete;
+    VectorView& operator=(VectorView&& other) noexcept;
+
+    // Бросает std::runtime_error, если файл не открывается или его формат не подходит для T
+    static VectorView Open(const std::string& path);
+
+    void Swap(VectorView& other) noexcept;
+
+    size_t Size() const noexcept {
+        return size_;
+    }
+
+    const T* Data() const noexcept {
+        return data_;
+    }
+
+    const T& operator[](size_t index) const noexcept {
+        VECTOR_CHECK(index < size_);
+        return data_[index];
+    }
+
+    const_iterator begin() const noexcept {
+        return data_;
+    }
+    const_iterator end() const noexcept {
+        return data_ + size_;
+    }
+
+private:
+    const T* data_ = nullptr;
+    size_t size_ = 0;
+#if defined(VECTOR_IO_MMAP)
+    void* mapping_ = nullptr;
+    size_t mapping_size_ = 0;
+#else
+    RawMemory<T> buffer_;
+#endif
+};
+
+
+template <typename T>
+VectorFileHeader VectorFileHeader::For(uint64_t count) noexcept {
+    VectorFileHeader header;
+    header.element_size = sizeof(T);
+    header.element_alignment = alignof(T);
+    header.data_offset = kVectorFileDataOffset;
+    header.count = count;
+    return header;
+}
+
+template <typename T>
+void VectorFileHeader::Validate() const {
+    if (std::memcmp(magic, kMagic, sizeof(kMagic)) != 0) {
+        throw std::runtime_error("vector file: bad magic");
+    }
+    if (version != kVersion) {
+        throw std::runtime_error("vector file: unsupported version " + std::to_string(version));
+    }
+    if (byte_order != kByteOrderMark) {
+        throw std::runtime_error("vector file: foreign byte order");
+    }
+    if (element_size != sizeof(T) || element_alignment != alignof(T)) {
+        throw std::runtime_error("vector file: element type mismatch");
+    }
+    if (data_offset < sizeof(VectorFileHeader) || data_offset % alignof(T) != 0) {
+        throw std::runtime_error("vector file: bad data offset");
+    }
+}
+
+namespace detail {
+
+    inline void WriteHeader(std::ostream& out, const VectorFileHeader& header) {
+        char block[kVectorFileDataOffset] = {};
+        std::memcpy(block, &header, sizeof(header));
+        out.write(block, sizeof(block));
+    }
+
+    inline VectorFileHeader ReadHeader(std::istream& in) {
+        VectorFileHeader header;
+        if (!in.read(reinterpret_cast<char*>(&header), sizeof(header))) {
+            throw std::runtime_error("vector file: truncated header");
+        }
+        return header;
+    }
+
+    // Проверяет число элементов из заголовка до выделения памяти под них: оно должно помещаться
+    // в size_t байт, а если поток позволяет узнать свою длину — не превышать оставшихся в нём данных.
+    // Поток должен стоять на начале данных
+    template <typename T>
+    void CheckElementCount(std::istream& in, uint64_t count) {
+        const uint64_t max_count = std::min<uint64_t>(std::numeric_limits<size_t>::max(),
+                                                      std::numeric_limits<std::streamsize>::max()) / sizeof(T);
+        if (count > max_count) {
+            throw std::runtime_error("vector file: element count too large");
+        }
+        const std::istream::pos_type data_pos = in.tellg();
+        if (data_pos == std::istream::pos_type(-1)) {
+            return;
+        }
+        in.seekg(0, std::ios::end);
+        const std::istream::pos_type end_pos = in.tellg();
+        in.seekg(data_pos);
+        if (!in) {
+            throw std::runtime_error("vector file: seek failed");
+        }
+        if (end_pos != std::istream::pos_type(-1) && count > static_cast<uint64_t>(end_pos - data_pos) / sizeof(T)) {
+            throw std::runtime_error("vector file: truncated data");
+        }
+    }
+
+}  // namespace detail
+
+template <typename T>
+VectorWriter<T>::VectorWriter(std::ostream& out)
+        : out_(out), header_pos_(out.tellp()) {
+    detail::WriteHeader(out_, VectorFileHeader::For<T>(0));
+}
+
+template <typename T>
+void VectorWriter<T>::Write(const T* values, size_t count) {
+    out_.write(reinterpret_cast<const char*>(values), static_cast<std::streamsize>(count * sizeof(T)));
+    count_ += count;
+}
+
+template <typename T>
+void VectorWriter<T>::Finish() {
+    const auto end = out_.tellp();
+    out_.seekp(header_pos_);
+    detail::WriteHeader(out_, VectorFileHeader::For<T>(count_));
+    out_.seekp(end);
+    if (!out_) {
+        throw std::runtime_error("vector file: write failed");
+    }
+}
+
+template <typename T, typename Alloc, typename Growth, typename Stats, typename Ownership>
+void WriteVector(std::ostream& out, const Vector<T, Alloc, Growth, Stats, Ownership>& values) {
+    static_assert(std::is_trivially_copyable_v<T>, "only trivially copyable types are stored as raw bytes");
+    detail::WriteHeader(out, VectorFileHeader::For<T>(values.Size()));
+    out.write(reinterpret_cast<const char*>(values.Data()), static_cast<std::streamsize>(values.Size() * sizeof(T)));
+    if (!out) {
+        throw std::runtime_error("vector file: write failed");
+    }
+}
+
+template <typename T>
+Vector<T> ReadVector(std::istream& in) {
+    static_assert(std::is_trivially_copyable_v<T>, "only trivially copyable types are stored as raw bytes");
+    const VectorFileHeader header = detail::ReadHeader(in);
+    header.Validate<T>();
+    in.ignore(header.data_offset - sizeof(header));
+    detail::CheckElementCount<T>(in, header.count);
+
+    Vector<T> values(static_cast<size_t>(header.count), kDefaultInit);
+    if (!in.read(reinterpret_cast<char*>(values.Data()), static_cast<std::streamsize>(values.Size() * sizeof(T)))) {
+        throw std::runtime_error("vector file: truncated data");
+    }
+    return values;
+}
+
+template <typename T>
+VectorView<T>::VectorView(VectorView&& other) noexcept {
+    Swap(other);
+}
+
+template <typename T>
+VectorView<T>::~VectorView() {
+#if defined(VECTOR_IO_MMAP)
+    if (mapping_ != nullptr) {
+        munmap(mapping_, mapping_size_);
+    }
+#endif
+}
+
+template <typename T>
+VectorView<T>& VectorView<T>::operator=(VectorView&& other) noexcept {
+    if (&other != this) {
+        VectorView moved(std::move(other));
+        Swap(moved);
+    }
+    return *this;
+}
+
+template <typename T>
+void VectorView<T>::Swap(VectorView& other) noexcept {
+    std::swap(data_, other.data_);
+    std::swap(size_, other.size_);
+#if defined(VECTOR_IO_MMAP)
+    std::swap(mapping_, other.mapping_);
+    std::swap(mapping_size_, other.mapping_size_);
+#else
+    buffer_.Swap(other.buffer_);
+#endif
+}
+
+template <typename T>
+VectorView<T> VectorView<T>::Open(const std::string& path) {
+    VectorView view;
+#if defined(VECTOR_IO_MMAP)
+    const int fd = open(path.c_str(), O_RDONLY);
+    if (fd < 0) {
+        throw std::runtime_error("vector file: cannot open " + path);
+    }
+    struct stat info {};
+    const bool stat_ok = fstat(fd, &info) == 0;
+    const auto file_size = stat_ok ? static_cast<size_t>(info.st_size) : 0;
+    void* mapping = file_size >= sizeof(VectorFileHeader)
+                    ? mmap(nullptr, file_size, PROT_READ, MAP_PRIVATE, fd, 0)
+                    : MAP_FAILED;
+    close(fd);
+    if (mapping == MAP_FAILED) {
+        throw std::runtime_error("vector file: cannot map " + path);
+    }
+    view.mapping_ = mapping;
+    view.mapping_size_ = file_size;
+
+    VectorFileHeader header;
+    std::memcpy(&header, mapping, sizeof(header));
+    header.Validate<T>();
+    if (file_size < header.data_offset || header.count > (file_size - header.data_offset) / sizeof(T)) {
+        throw std::runtime_error("vector file: truncated data");
+    }
+    view.data_ = reinterpret_cast<const T*>(static_cast<const unsigned char*>(mapping) + header.data_offset);
+    view.size_ = static_cast<size_t>(header.count);
+#else
+    std::ifstream in(path, std::ios::binary);
+    if (!in) {
+        throw std::runtime_error("vector file: cannot open " + path);
+    }
+    const VectorFileHeader header = detail::ReadHeader(in);
+    header.Validate<T>();
+    in.ignore(header.data_offset - sizeof(header));
+    detail::CheckElementCount<T>(in, header.count);
+    RawMemory<T> buffer(static_cast<size_t>(header.count));
+    if (!in.read(reinterpret_cast<char*>(buffer.GetAddress()), static_cast<std::streamsize>(header.count * sizeof(T)))) {
+        throw std::runtime_error("vector file: truncated data");
+    }
+    view.buffer_.Swap(buffer);
+    view.data_ = view.buffer_.GetAddress();
+    view.size_ = static_cast<size_t>(header.count);
+#endif
+    return view;
+}